@@ -43,6 +43,10 @@ void thread_join (abstr_thread_t thread) {
     pthread_join(thread, NULL);
 }
 
+void thread_detach (abstr_thread_t thread) {
+    pthread_detach(thread);
+}
+
 int fusermount (char *path) {
     char *argv[] = {(char *) "umount", path, NULL};
 
@@ -61,6 +65,10 @@ void thread_join (HANDLE thread) {
     WaitForSingleObject(thread, INFINITE);
 }
 
+void thread_detach (HANDLE thread) {
+    CloseHandle(thread);
+}
+
 int fusermount (char *path) {
     char* dokanPath = getenv("DokanLibrary1");
     char cmdLine[MAX_PATH];
@@ -112,6 +120,10 @@ void thread_join (abstr_thread_t thread) {
     pthread_join(thread, NULL);
 }
 
+void thread_detach (abstr_thread_t thread) {
+    pthread_detach(thread);
+}
+
 int fusermount (char *path) {
     char *argv[] = {(char *) "fusermount", (char *) "-q", (char *) "-u", path, NULL};
 
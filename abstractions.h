@@ -31,6 +31,12 @@ NAN_INLINE static void semaphore_signal (dispatch_semaphore_t *sem) {
 
 extern pthread_mutex_t mutex;
 
+typedef pthread_mutex_t bindings_mutex_t;
+
+NAN_INLINE static int mutex_init (pthread_mutex_t *mutex) {
+    return pthread_mutex_init(mutex, NULL);
+}
+
 NAN_INLINE static void mutex_lock (pthread_mutex_t *mutex) {
     pthread_mutex_lock(mutex);
 }
@@ -51,7 +57,7 @@ typedef void* thread_fn_rtn_t;
 typedef HANDLE bindings_sem_t;
 
 NAN_INLINE static int semaphore_init (HANDLE *sem) {
-  *sem = CreateSemaphore(NULL, 0, 10, NULL);
+  *sem = CreateSemaphore(NULL, 0, 0x7fffffff, NULL);
   return *sem == NULL ? -1 : 0;
 }
 
@@ -65,6 +71,13 @@ NAN_INLINE static void semaphore_signal (HANDLE *sem) {
 
 extern HANDLE mutex;
 
+typedef HANDLE bindings_mutex_t;
+
+NAN_INLINE static int mutex_init (HANDLE *mutex) {
+    *mutex = CreateMutex(NULL, false, NULL);
+    return *mutex == NULL ? -1 : 0;
+}
+
 NAN_INLINE static void mutex_lock (HANDLE *mutex) {
     WaitForSingleObject(*mutex, INFINITE);
 }
@@ -87,6 +100,22 @@ typedef DWORD thread_fn_rtn_t;
 #include <semaphore.h>
 #include <fuse_lowlevel.h>
 
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#define BINDINGS_HAS_FUTEX 1
+
+NAN_INLINE static void futex_wait (int *addr, int val) {
+  syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+}
+
+NAN_INLINE static void futex_wake (int *addr) {
+  syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+#endif
+
 #define FUSE_OFF_T off_t
 
 typedef sem_t bindings_sem_t;
@@ -105,6 +134,12 @@ NAN_INLINE static void semaphore_signal (sem_t *sem) {
 
 extern pthread_mutex_t mutex;
 
+typedef pthread_mutex_t bindings_mutex_t;
+
+NAN_INLINE static int mutex_init (pthread_mutex_t *mutex) {
+    return pthread_mutex_init(mutex, NULL);
+}
+
 NAN_INLINE static void mutex_lock (pthread_mutex_t *mutex) {
     pthread_mutex_lock(mutex);
 }
@@ -118,9 +153,94 @@ typedef void* thread_fn_rtn_t;
 
 #endif
 
+#include <atomic>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BINDINGS_HAS_SSE2 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define BINDINGS_HAS_NEON 1
+#endif
+
+// true if none of the bytes have the high bit set, 16 at a time where we can
+NAN_INLINE static bool is_ascii (const char *str, size_t len) {
+  size_t i = 0;
+#if defined(BINDINGS_HAS_SSE2)
+  for (; i + 16 <= len; i += 16) {
+    if (_mm_movemask_epi8(_mm_loadu_si128((const __m128i *) (str + i)))) return false;
+  }
+#elif defined(BINDINGS_HAS_NEON)
+  for (; i + 16 <= len; i += 16) {
+    if (vmaxvq_u8(vld1q_u8((const uint8_t *) (str + i))) >= 0x80) return false;
+  }
+#endif
+  for (; i < len; i++) {
+    if ((unsigned char) str[i] >= 0x80) return false;
+  }
+  return true;
+}
+
+NAN_INLINE static void cpu_relax () {
+#if defined(_MSC_VER)
+  YieldProcessor();
+#elif defined(__i386__) || defined(__x86_64__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  __asm__ __volatile__("yield");
+#endif
+}
+
+// One-shot completion the waiter can busy-poll for a while before going to sleep.
+// state is 0 while pending, 1 when done and 2 once the waiter is asleep, so the
+// signaller only pays for a wakeup syscall when somebody is actually sleeping.
+struct bindings_completion_t {
+  std::atomic<int> state;
+#ifndef BINDINGS_HAS_FUTEX
+  bindings_sem_t semaphore;
+#endif
+};
+
+NAN_INLINE static void completion_init (bindings_completion_t *c) {
+  c->state.store(0);
+#ifndef BINDINGS_HAS_FUTEX
+  semaphore_init(&(c->semaphore));
+#endif
+}
+
+NAN_INLINE static void completion_reset (bindings_completion_t *c) {
+  c->state.store(0, std::memory_order_relaxed);
+}
+
+NAN_INLINE static void completion_wait (bindings_completion_t *c, int spin) {
+  for (int i = 0; i < spin; i++) {
+    if (c->state.load(std::memory_order_acquire) == 1) return;
+    cpu_relax();
+  }
+
+  int expected = 0;
+  if (!c->state.compare_exchange_strong(expected, 2, std::memory_order_acq_rel)) return;
+
+#ifdef BINDINGS_HAS_FUTEX
+  while (c->state.load(std::memory_order_acquire) != 1) futex_wait((int *) &(c->state), 2);
+#else
+  semaphore_wait(&(c->semaphore));
+#endif
+}
+
+NAN_INLINE static void completion_signal (bindings_completion_t *c) {
+  if (c->state.exchange(1, std::memory_order_acq_rel) != 2) return;
+#ifdef BINDINGS_HAS_FUTEX
+  futex_wake((int *) &(c->state));
+#else
+  semaphore_signal(&(c->semaphore));
+#endif
+}
+
 typedef thread_fn_rtn_t(*thread_fn)(void*);
 
 void thread_create (abstr_thread_t*, thread_fn, void*);
 void thread_join (abstr_thread_t);
+void thread_detach (abstr_thread_t);
 
 int fusermount (char*);
@@ -0,0 +1,379 @@
+// Workload driver the benchmarks run against a mounted filesystem, see bench/index.js.
+// Runs one workload in --procs processes and prints a single json object with the
+// throughput and latency percentiles to stdout.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <getopt.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "../stats.h"
+
+enum bench_workload_t {
+  WORKLOAD_SEQ_READ = 0,
+  WORKLOAD_RAND_READ,
+  WORKLOAD_SEQ_WRITE,
+  WORKLOAD_RAND_WRITE,
+  WORKLOAD_STAT,
+  WORKLOAD_READDIR,
+  WORKLOAD_CREATE,
+  WORKLOAD_UNLINK,
+  WORKLOAD_MIXED,
+  WORKLOAD_LENGTH
+};
+
+static const char *bench_workload_names[] = {
+  "seq-read",
+  "rand-read",
+  "seq-write",
+  "rand-write",
+  "stat",
+  "readdir",
+  "create",
+  "unlink",
+  "mixed"
+};
+
+struct bench_options_t {
+  const char *dir;
+  int workload;
+  size_t block_size;
+  uint64_t size; // of the file written by seq-write and rand-write
+  int files; // number of entries in <dir>/files, and files each unlink worker creates
+  uint64_t ops; // per process, 0 for no limit
+  double duration;
+  int procs;
+};
+
+// lives in shared memory so all worker processes record into the same histogram
+struct bench_shared_t {
+  bindings_hist_t latency;
+  std::atomic<uint64_t> ops;
+  std::atomic<uint64_t> bytes;
+  std::atomic<uint64_t> errors;
+  std::atomic<uint64_t> elapsed; // longest time a worker spent running the workload, setup excluded
+};
+
+struct bench_worker_t {
+  int id;
+  int fd;
+  char *buf;
+  uint64_t size;
+  uint64_t position;
+  uint64_t rng;
+  char path[8192];
+  char files[4096];
+};
+
+static uint64_t bench_now () {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint64_t bench_random (bench_worker_t *w) { // xorshift64
+  w->rng ^= w->rng << 13;
+  w->rng ^= w->rng >> 7;
+  w->rng ^= w->rng << 17;
+  return w->rng;
+}
+
+static uint64_t bench_random_offset (bench_options_t *o, bench_worker_t *w) {
+  uint64_t blocks = w->size / o->block_size;
+  return blocks ? (bench_random(w) % blocks) * o->block_size : 0;
+}
+
+static void bench_file_path (bench_options_t *o, bench_worker_t *w, uint64_t i) {
+  snprintf(w->path, sizeof(w->path), "%s/bench-%d-%llu", o->dir, w->id, (unsigned long long) i);
+}
+
+static ssize_t bench_stat (bench_options_t *o, bench_worker_t *w) {
+  struct stat st;
+  snprintf(w->path, sizeof(w->path), "%s/f%llu", w->files, (unsigned long long) (bench_random(w) % o->files));
+  return stat(w->path, &st);
+}
+
+static ssize_t bench_readdir (bench_worker_t *w) {
+  DIR *dir = opendir(w->files);
+  if (dir == NULL) return -1;
+  while (readdir(dir) != NULL);
+  closedir(dir);
+  return 0;
+}
+
+static int bench_setup (bench_options_t *o, bench_worker_t *w) {
+  snprintf(w->files, sizeof(w->files), "%s/files", o->dir);
+  w->buf = (char *) malloc(o->block_size);
+  if (w->buf == NULL) return -1;
+  memset(w->buf, 'a' + w->id % 26, o->block_size);
+  w->fd = -1;
+  w->size = o->size;
+
+  switch (o->workload) {
+    case WORKLOAD_SEQ_READ:
+    case WORKLOAD_RAND_READ:
+    case WORKLOAD_MIXED: {
+      struct stat st;
+      snprintf(w->path, sizeof(w->path), "%s/data", o->dir);
+      w->fd = open(w->path, o->workload == WORKLOAD_MIXED ? O_RDWR : O_RDONLY);
+      if (w->fd == -1 || fstat(w->fd, &st) == -1) return -1;
+      w->size = st.st_size;
+    }
+    return 0;
+
+    case WORKLOAD_SEQ_WRITE:
+    case WORKLOAD_RAND_WRITE: {
+      bench_file_path(o, w, 0);
+      w->fd = open(w->path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+      if (w->fd == -1) return -1;
+      // rand-write overwrites existing blocks, so lay the file out first
+      if (o->workload == WORKLOAD_RAND_WRITE && ftruncate(w->fd, w->size) == -1) return -1;
+    }
+    return 0;
+
+    case WORKLOAD_UNLINK: {
+      for (int i = 0; i < o->files; i++) {
+        bench_file_path(o, w, i);
+        int fd = open(w->path, O_WRONLY | O_CREAT, 0644);
+        if (fd == -1) return -1;
+        close(fd);
+      }
+    }
+    return 0;
+  }
+
+  return 0;
+}
+
+static void bench_teardown (bench_options_t *o, bench_worker_t *w, uint64_t ops) {
+  if (w->fd != -1) close(w->fd);
+  free(w->buf);
+
+  switch (o->workload) {
+    case WORKLOAD_SEQ_WRITE:
+    case WORKLOAD_RAND_WRITE: {
+      bench_file_path(o, w, 0);
+      unlink(w->path);
+    }
+    break;
+
+    case WORKLOAD_CREATE: {
+      for (uint64_t i = 0; i < ops; i++) {
+        bench_file_path(o, w, i);
+        unlink(w->path);
+      }
+    }
+    break;
+  }
+}
+
+// returns the bytes transferred or -1 on error
+static ssize_t bench_op (bench_options_t *o, bench_worker_t *w, int workload, uint64_t i) {
+  switch (workload) {
+    case WORKLOAD_SEQ_READ: {
+      ssize_t n = read(w->fd, w->buf, o->block_size);
+      if (n != 0) return n;
+      lseek(w->fd, 0, SEEK_SET);
+      return read(w->fd, w->buf, o->block_size);
+    }
+
+    case WORKLOAD_RAND_READ:
+    return pread(w->fd, w->buf, o->block_size, bench_random_offset(o, w));
+
+    case WORKLOAD_SEQ_WRITE: {
+      if (w->position + o->block_size > w->size) {
+        lseek(w->fd, 0, SEEK_SET);
+        w->position = 0;
+      }
+      w->position += o->block_size;
+      return write(w->fd, w->buf, o->block_size);
+    }
+
+    case WORKLOAD_RAND_WRITE:
+    return pwrite(w->fd, w->buf, o->block_size, bench_random_offset(o, w));
+
+    case WORKLOAD_STAT:
+    return bench_stat(o, w);
+
+    case WORKLOAD_READDIR:
+    return bench_readdir(w);
+
+    case WORKLOAD_CREATE: {
+      bench_file_path(o, w, i);
+      int fd = open(w->path, O_WRONLY | O_CREAT, 0644);
+      if (fd == -1) return -1;
+      close(fd);
+      return 0;
+    }
+
+    case WORKLOAD_UNLINK: {
+      bench_file_path(o, w, i);
+      return unlink(w->path);
+    }
+
+    case WORKLOAD_MIXED: { // 50% stat, 30% random reads, 10% random writes, 10% listings
+      uint64_t r = bench_random(w) % 100;
+      if (r < 50) return bench_op(o, w, WORKLOAD_STAT, i);
+      if (r < 80) return bench_op(o, w, WORKLOAD_RAND_READ, i);
+      if (r < 90) return bench_op(o, w, WORKLOAD_RAND_WRITE, i);
+      return bench_op(o, w, WORKLOAD_READDIR, i);
+    }
+  }
+
+  return -1;
+}
+
+static int bench_worker (bench_options_t *o, bench_shared_t *shared, int id) {
+  bench_worker_t w;
+  memset(&w, 0, sizeof(w));
+  w.id = id;
+  w.rng = 0x9e3779b97f4a7c15ULL ^ ((uint64_t) getpid() << 16) ^ id;
+
+  if (bench_setup(o, &w) == -1) {
+    fprintf(stderr, "bench_driver: setup failed: %s: %s\n", w.path, strerror(errno));
+    return 1;
+  }
+
+  uint64_t limit = o->ops;
+  if (o->workload == WORKLOAD_UNLINK && (!limit || limit > (uint64_t) o->files)) limit = o->files;
+
+  uint64_t begin = bench_now();
+  uint64_t deadline = begin + (uint64_t) (o->duration * 1e9);
+  uint64_t i = 0;
+
+  for (; !limit || i < limit; i++) {
+    uint64_t start = bench_now();
+    if (start >= deadline) break;
+
+    ssize_t n = bench_op(o, &w, o->workload, i);
+    bindings_hist_record(&(shared->latency), bench_now() - start);
+
+    if (n < 0) shared->errors.fetch_add(1, std::memory_order_relaxed);
+    else shared->bytes.fetch_add(n, std::memory_order_relaxed);
+    shared->ops.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  uint64_t elapsed = bench_now() - begin;
+  uint64_t max = shared->elapsed.load();
+  while (elapsed > max && !shared->elapsed.compare_exchange_weak(max, elapsed));
+
+  bench_teardown(o, &w, i);
+  return 0;
+}
+
+static void bench_usage () {
+  fprintf(stderr,
+    "usage: bench_driver <dir> <workload> [options]\n"
+    "\n"
+    "workloads: seq-read rand-read seq-write rand-write stat readdir create unlink mixed\n"
+    "\n"
+    "  --block-size <bytes>  io size of reads and writes (4096)\n"
+    "  --size <bytes>        size of the file written by the write workloads (16777216)\n"
+    "  --files <n>           entries in <dir>/files, files created per process by unlink (1000)\n"
+    "  --ops <n>             operations per process, 0 for no limit (0)\n"
+    "  --duration <seconds>  (5)\n"
+    "  --procs <n>           processes running the workload at once (1)\n");
+}
+
+int main (int argc, char **argv) {
+  bench_options_t o;
+  o.block_size = 4096;
+  o.size = 16 * 1024 * 1024;
+  o.files = 1000;
+  o.ops = 0;
+  o.duration = 5;
+  o.procs = 1;
+
+  static struct option long_options[] = {
+    {"block-size", required_argument, NULL, 'b'},
+    {"size", required_argument, NULL, 's'},
+    {"files", required_argument, NULL, 'f'},
+    {"ops", required_argument, NULL, 'n'},
+    {"duration", required_argument, NULL, 'd'},
+    {"procs", required_argument, NULL, 'p'},
+    {NULL, 0, NULL, 0}
+  };
+
+  int c;
+  while ((c = getopt_long(argc, argv, "b:s:f:n:d:p:", long_options, NULL)) != -1) {
+    switch (c) {
+      case 'b': o.block_size = strtoull(optarg, NULL, 10); break;
+      case 's': o.size = strtoull(optarg, NULL, 10); break;
+      case 'f': o.files = atoi(optarg); break;
+      case 'n': o.ops = strtoull(optarg, NULL, 10); break;
+      case 'd': o.duration = atof(optarg); break;
+      case 'p': o.procs = atoi(optarg); break;
+      default: bench_usage(); return 1;
+    }
+  }
+
+  if (argc - optind != 2) {
+    bench_usage();
+    return 1;
+  }
+
+  o.dir = argv[optind];
+  o.workload = -1;
+  for (int i = 0; i < WORKLOAD_LENGTH; i++) {
+    if (!strcmp(argv[optind + 1], bench_workload_names[i])) o.workload = i;
+  }
+
+  if (o.workload == -1 || o.block_size == 0 || o.files < 1 || o.procs < 1) {
+    bench_usage();
+    return 1;
+  }
+
+  bench_shared_t *shared = (bench_shared_t *) mmap(NULL, sizeof(bench_shared_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (shared == MAP_FAILED) {
+    perror("bench_driver: mmap");
+    return 1;
+  }
+
+  int failed = 0;
+
+  for (int i = 0; i < o.procs; i++) {
+    pid_t pid = fork();
+    if (pid == 0) _exit(bench_worker(&o, shared, i));
+    if (pid == -1) failed++;
+  }
+
+  int status;
+  while (wait(&status) > 0) {
+    if (!WIFEXITED(status) || WEXITSTATUS(status)) failed++;
+  }
+
+  double seconds = shared->elapsed.load() / 1e9;
+  if (seconds <= 0) seconds = 1e-9;
+  uint64_t ops = shared->ops.load();
+  uint64_t bytes = shared->bytes.load();
+  bindings_hist_t *latency = &(shared->latency);
+  uint64_t count = latency->count.load();
+
+  printf("{\"workload\":\"%s\",\"blockSize\":%llu,\"procs\":%d,\"ops\":%llu,\"bytes\":%llu,\"errors\":%llu,\"seconds\":%.6f,"
+    "\"opsPerSec\":%.2f,\"mbPerSec\":%.2f,\"latency\":{\"mean\":%.0f,\"p50\":%llu,\"p99\":%llu,\"p999\":%llu,\"max\":%llu}}\n",
+    bench_workload_names[o.workload],
+    (unsigned long long) o.block_size,
+    o.procs,
+    (unsigned long long) ops,
+    (unsigned long long) bytes,
+    (unsigned long long) shared->errors.load(),
+    seconds,
+    ops / seconds,
+    bytes / seconds / (1024 * 1024),
+    count ? (double) latency->sum.load() / count : 0,
+    (unsigned long long) bindings_hist_quantile(latency, 0.5),
+    (unsigned long long) bindings_hist_quantile(latency, 0.99),
+    (unsigned long long) bindings_hist_quantile(latency, 0.999),
+    (unsigned long long) latency->max.load());
+
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,125 @@
+// runs bench_driver workloads against the reference filesystems and prints the results as json
+//
+//   node bench [--fs memory|null] [--workloads stat,seq-read,...] [--block-sizes 4096,131072]
+//              [--procs 1,4] [--duration 5] [--files 1000] [--data-size 67108864] [--multithread] [--stats]
+
+var fuse = require('../')
+var fs = require('fs')
+var os = require('os')
+var path = require('path')
+var execFile = require('child_process').execFile
+
+var WORKLOADS = ['seq-read', 'rand-read', 'seq-write', 'rand-write', 'stat', 'readdir', 'create', 'unlink', 'mixed']
+var IO_WORKLOADS = ['seq-read', 'rand-read', 'seq-write', 'rand-write', 'mixed']
+
+var argv = parse(process.argv.slice(2))
+var opts = {
+  fs: argv.fs || 'memory',
+  workloads: list(argv.workloads, WORKLOADS),
+  blockSizes: list(argv['block-sizes'], [4096, 131072]).map(Number),
+  procs: list(argv.procs, [1, 4]).map(Number),
+  duration: Number(argv.duration || 5),
+  files: Number(argv.files || 1000),
+  dataSize: Number(argv['data-size'] || 64 * 1024 * 1024),
+  multithread: !!argv.multithread,
+  stats: !!argv.stats
+}
+
+var driver = findDriver()
+if (!driver) {
+  console.error('bench_driver not found, build it with node-gyp rebuild --build_bench=1')
+  process.exit(1)
+}
+
+var mnt = path.join(os.tmpdir(), 'fuse-bindings-bench')
+try {
+  fs.mkdirSync(mnt)
+} catch (err) {
+  // already exists
+}
+
+var ops = require('./' + opts.fs)({files: opts.files, dataSize: opts.dataSize})
+ops.force = true
+ops.multithread = opts.multithread
+ops.stats = opts.stats
+
+var runs = []
+opts.workloads.forEach(function (workload) {
+  var blockSizes = IO_WORKLOADS.indexOf(workload) > -1 ? opts.blockSizes : [opts.blockSizes[0]]
+  blockSizes.forEach(function (blockSize) {
+    opts.procs.forEach(function (procs) {
+      runs.push([
+        mnt, workload,
+        '--block-size', blockSize,
+        '--procs', procs,
+        '--duration', opts.duration,
+        '--files', opts.files
+      ].map(String))
+    })
+  })
+})
+
+fuse.mount(mnt, ops, function (err) {
+  if (err) throw err
+
+  var results = []
+  var loop = function () {
+    var args = runs.shift()
+    if (!args) return done(results)
+
+    console.error('bench_driver ' + args.slice(1).join(' '))
+    execFile(driver, args, function (err, stdout, stderr) {
+      if (err) {
+        fuse.unmount(mnt, function () {
+          console.error(stderr)
+          throw err
+        })
+        return
+      }
+      results.push(JSON.parse(stdout))
+      loop()
+    })
+  }
+
+  loop()
+})
+
+function done (results) {
+  var report = {
+    fs: opts.fs,
+    multithread: opts.multithread,
+    node: process.version,
+    platform: os.platform(),
+    results: results
+  }
+
+  if (opts.stats) report.stats = fuse.stats(mnt)
+
+  fuse.unmount(mnt, function () {
+    console.log(JSON.stringify(report, null, 2))
+  })
+}
+
+function findDriver () {
+  var dirs = ['Release', 'Debug']
+  for (var i = 0; i < dirs.length; i++) {
+    var file = path.join(__dirname, '..', 'build', dirs[i], 'bench_driver')
+    if (fs.existsSync(file)) return file
+  }
+  return null
+}
+
+function list (value, defaults) {
+  return value ? String(value).split(',') : defaults
+}
+
+function parse (args) {
+  var result = {}
+  for (var i = 0; i < args.length; i++) {
+    if (args[i].slice(0, 2) !== '--') continue
+    var next = args[i + 1]
+    if (next === undefined || next.slice(0, 2) === '--') result[args[i].slice(2)] = true
+    else result[args[i].slice(2)] = args[++i]
+  }
+  return result
+}
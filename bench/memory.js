@@ -0,0 +1,119 @@
+// in memory filesystem the benchmarks run against, it does the bookkeeping a real
+// filesystem would so the numbers include some handler work. see null.js for the other end
+
+var fuse = require('../')
+
+var DIR = 16877
+var FILE = 33188
+
+module.exports = function (opts) {
+  if (!opts) opts = {}
+
+  var now = new Date()
+  var entries = {}
+
+  var entry = function (mode) {
+    return {mode: mode, size: 0, data: mode === FILE ? new Buffer(0) : null, children: mode === DIR ? {} : null, mtime: now}
+  }
+
+  var add = function (name, e) {
+    var i = name.lastIndexOf('/')
+    var parent = entries[name.slice(0, i) || '/']
+    if (!parent || !parent.children) return fuse.ENOENT
+    if (entries[name]) return fuse.EEXIST
+    parent.children[name.slice(i + 1)] = true
+    entries[name] = e
+    return 0
+  }
+
+  var remove = function (name) {
+    var i = name.lastIndexOf('/')
+    delete entries[name.slice(0, i) || '/'].children[name.slice(i + 1)]
+    delete entries[name]
+  }
+
+  var resize = function (e, size) {
+    if (size > e.data.length) {
+      var data = new Buffer(Math.max(size, 2 * e.data.length))
+      e.data.copy(data, 0, 0, e.size)
+      data.fill(0, e.size)
+      e.data = data
+    } else if (size > e.size) {
+      e.data.fill(0, e.size, size)
+    }
+    e.size = size
+  }
+
+  entries['/'] = entry(DIR)
+  add('/files', entry(DIR))
+  for (var i = 0; i < (opts.files || 0); i++) add('/files/f' + i, entry(FILE))
+
+  var data = entry(FILE)
+  resize(data, opts.dataSize || 0)
+  data.data.fill('a')
+  add('/data', data)
+
+  var truncate = function (name, size, cb) {
+    var e = entries[name]
+    if (!e || !e.data) return cb(fuse.ENOENT)
+    resize(e, size)
+    cb(0)
+  }
+
+  return {
+    getattr: function (name, cb) {
+      var e = entries[name]
+      if (!e) return cb(fuse.ENOENT)
+      cb(0, {mtime: e.mtime, atime: e.mtime, ctime: e.mtime, nlink: 1, size: e.size, mode: e.mode, uid: process.getuid(), gid: process.getgid()})
+    },
+    readdir: function (name, cb) {
+      var e = entries[name]
+      if (!e || !e.children) return cb(fuse.ENOENT)
+      cb(0, Object.keys(e.children))
+    },
+    open: function (name, flags, cb) {
+      cb(entries[name] ? 0 : fuse.ENOENT, 0)
+    },
+    create: function (name, mode, cb) {
+      cb(add(name, entry(FILE)), 0)
+    },
+    truncate: truncate,
+    ftruncate: function (name, fd, size, cb) {
+      truncate(name, size, cb)
+    },
+    read: function (name, fd, buf, len, pos, cb) {
+      var e = entries[name]
+      if (!e || !e.data) return cb(fuse.ENOENT)
+      if (pos >= e.size) return cb(0)
+      cb(e.data.copy(buf, 0, pos, Math.min(e.size, pos + len)))
+    },
+    write: function (name, fd, buf, len, pos, cb) {
+      var e = entries[name]
+      if (!e || !e.data) return cb(fuse.ENOENT)
+      if (pos + len > e.size) resize(e, pos + len)
+      buf.copy(e.data, pos, 0, len)
+      e.mtime = new Date()
+      cb(len)
+    },
+    utimens: function (name, atime, mtime, cb) {
+      cb(entries[name] ? 0 : fuse.ENOENT)
+    },
+    unlink: function (name, cb) {
+      var e = entries[name]
+      if (!e) return cb(fuse.ENOENT)
+      if (e.children) return cb(fuse.EISDIR)
+      remove(name)
+      cb(0)
+    },
+    mkdir: function (name, mode, cb) {
+      cb(add(name, entry(DIR)))
+    },
+    rmdir: function (name, cb) {
+      var e = entries[name]
+      if (!e || !e.children) return cb(fuse.ENOENT)
+      if (Object.keys(e.children).length) return cb(fuse.ENOTEMPTY)
+      remove(name)
+      cb(0)
+    }
+  }
+}
@@ -0,0 +1,69 @@
+// micro benchmarks of the bindings' own overhead, each next to the native baseline it compares to.
+// prints ns per operation as json
+//
+//   node bench/micro [--iterations 100000] [--entries 100]
+
+require('../') // sets up the buffer and callback constructors the addon needs
+var path = require('path')
+var binding = require('node-gyp-build')(path.join(__dirname, '..'))
+
+var argv = process.argv.slice(2)
+var iterations = Number(arg('--iterations') || 100000)
+var entries = Number(arg('--entries') || 100)
+
+var stat = {
+  mtime: new Date(),
+  atime: new Date(),
+  ctime: new Date(),
+  nlink: 1,
+  size: 4096,
+  mode: 33188,
+  uid: process.getuid(),
+  gid: process.getgid()
+}
+
+var names = []
+for (var i = 0; i < entries; i++) names.push('file-' + i)
+
+var results = {}
+
+results.noop = binding.benchmark('noop', iterations)
+results.setStat = compare(binding.benchmark('set_stat', iterations, stat), binding.benchmark('copy_stat', iterations))
+results.setStatTyped = compare(binding.benchmark('set_stat', iterations, new Float64Array(16)), results.setStat.baseline)
+results.buffer = compare(binding.benchmark('buffer', iterations, 4096), results.noop)
+
+roundtrip('roundtrip', function (path, mode, cb) {
+  cb(0)
+}, function () {
+  roundtrip('getattr', function (path, cb) {
+    cb(0, stat)
+  }, function () {
+    roundtrip('readdir', function (path, cb) {
+      cb(0, names)
+    }, function () {
+      results.readdir.entries = entries
+      console.log(JSON.stringify({iterations: iterations, node: process.version, results: results}, null, 2))
+    })
+  })
+})
+
+function roundtrip (name, handler, cb) {
+  // the baseline is the same trip through the queue and completion with nothing answering in js
+  binding.benchmark(name, iterations, null, function (err, baseline) {
+    if (err) throw err
+    binding.benchmark(name, iterations, handler, function (err, ns) {
+      if (err) throw err
+      results[name] = compare(ns, baseline)
+      cb()
+    })
+  })
+}
+
+function compare (ns, baseline) {
+  return {ns: ns, baseline: baseline, overhead: ns - baseline}
+}
+
+function arg (name) {
+  var i = argv.indexOf(name)
+  return i > -1 ? argv[i + 1] : null
+}
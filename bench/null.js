@@ -0,0 +1,65 @@
+// filesystem that does as little as possible in its handlers, so benchmarks against
+// it measure the bindings themselves. reads aren't filled in and writes are dropped
+
+var fuse = require('../')
+
+module.exports = function (opts) {
+  if (!opts) opts = {}
+
+  var now = new Date()
+  var dataSize = opts.dataSize || 0
+  var names = []
+  var created = {}
+
+  for (var i = 0; i < (opts.files || 0); i++) names.push('f' + i)
+
+  var stat = function (mode, size) {
+    return {mtime: now, atime: now, ctime: now, nlink: 1, size: size, mode: mode, uid: process.getuid(), gid: process.getgid()}
+  }
+
+  var dir = stat(16877, 4096)
+  var file = stat(33188, 0)
+  var data = stat(33188, dataSize)
+
+  return {
+    getattr: function (name, cb) {
+      if (name === '/' || name === '/files') return cb(0, dir)
+      if (name === '/data') return cb(0, data)
+      if (created[name] || /^\/files\/f\d+$/.test(name)) return cb(0, file)
+      cb(fuse.ENOENT)
+    },
+    readdir: function (name, cb) {
+      if (name === '/files') return cb(0, names)
+      if (name === '/') return cb(0, ['data', 'files'].concat(Object.keys(created).map(function (n) { return n.slice(1) })))
+      cb(fuse.ENOENT)
+    },
+    open: function (name, flags, cb) {
+      cb(0, 0)
+    },
+    create: function (name, mode, cb) {
+      created[name] = true
+      cb(0, 0)
+    },
+    truncate: function (name, size, cb) {
+      cb(0)
+    },
+    ftruncate: function (name, fd, size, cb) {
+      cb(0)
+    },
+    read: function (name, fd, buf, len, pos, cb) {
+      if (name !== '/data') return cb(0)
+      cb(Math.max(0, Math.min(len, dataSize - pos)))
+    },
+    write: function (name, fd, buf, len, pos, cb) {
+      cb(len)
+    },
+    utimens: function (name, atime, mtime, cb) {
+      cb(0)
+    },
+    unlink: function (name, cb) {
+      if (!created[name]) return cb(fuse.ENOENT)
+      delete created[name]
+      cb(0)
+    }
+  }
+}
@@ -1,7 +1,10 @@
 {
+    "variables": {
+        "build_bench%": 0
+    },
     "targets": [{
         "target_name": "fuse_bindings",
-        "sources": ["fuse-bindings.cc", "abstractions.cc"],
+        "sources": ["fuse-bindings.cc", "abstractions.cc", "stats.cc", "trace.cc"],
         "include_dirs": [
             "<!(node -e \"require('nan')\")"
         ],
@@ -21,7 +24,8 @@
                 ],
                 "link_settings": {
                     "libraries": [
-                        "<@(fuse__libraries)"
+                        "<@(fuse__libraries)",
+                        "-ldl"
                     ]
                 }
             }],
@@ -63,5 +67,14 @@
                 }
             }
         }
-    }]
+    }],
+    "conditions": [
+        ['OS!="win" and build_bench==1', {
+            "targets": [{
+                "target_name": "bench_driver",
+                "type": "executable",
+                "sources": ["bench/driver.cc", "stats.cc"]
+            }]
+        }]
+    ]
 }
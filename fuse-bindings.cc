@@ -11,6 +11,9 @@
 
 #include <fuse.h>
 #include <fuse_opt.h>
+#ifndef _WIN32
+#include <fuse_lowlevel.h>
+#endif
 
 #ifndef _MSC_VER
 // Need to use FUSE_STAT when using Dokany with Visual Studio.
@@ -19,21 +22,94 @@
 #define FUSE_STAT stat
 #endif
 
+#if !defined(_WIN32) && !defined(__APPLE__)
+// reads served straight from a file descriptor need fuse_bufvec and splice, linux only
+#define BINDINGS_HAS_BUFVEC 1
+#endif
+
 #include <stdio.h>
 #include <string.h>
 #include <errno.h>
 #include <stdlib.h>
 #include <sys/types.h>
+#ifndef _WIN32
+#include <unistd.h>
+#include <dlfcn.h>
+#endif
+#if !defined(_WIN32) && !defined(__APPLE__)
+#include <mntent.h>
+#endif
 #include <iostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <deque>
+#include <list>
+#include <algorithm>
 
 #include "abstractions.h"
+#include "stats.h"
+#include "trace.h"
+#ifndef _WIN32
+#include "plugin.h"
+#endif
 
 using namespace v8;
 
 #define LOCAL_STRING(s) Nan::New<String>(s).ToLocalChecked()
 #define LOOKUP_CALLBACK(map, name) map->Has(LOCAL_STRING(name)) ? new Nan::Callback(map->Get(LOCAL_STRING(name)).As<Function>()) : NULL
+#define LOCAL_KEY(key) Nan::New(bindings_keys[key])
+
+#if defined(V8_MAJOR_VERSION) && (V8_MAJOR_VERSION > 6 || (V8_MAJOR_VERSION == 6 && V8_MINOR_VERSION >= 7))
+#define BINDINGS_HAS_BIGINT 1
+#endif
 
-static struct fuse_chan *ch = NULL;
+// property names read on every op, created (and internalized) once at load
+enum bindings_keys_t {
+  KEY_DEV = 0,
+  KEY_INO,
+  KEY_MODE,
+  KEY_NLINK,
+  KEY_UID,
+  KEY_GID,
+  KEY_RDEV,
+  KEY_SIZE,
+  KEY_BLOCKS,
+  KEY_BLKSIZE,
+  KEY_MTIME,
+  KEY_CTIME,
+  KEY_ATIME,
+  KEY_BSIZE,
+  KEY_FRSIZE,
+  KEY_BFREE,
+  KEY_BAVAIL,
+  KEY_FILES,
+  KEY_FFREE,
+  KEY_FAVAIL,
+  KEY_FSID,
+  KEY_FLAG,
+  KEY_NAMEMAX,
+  KEY_NAME,
+  KEY_STAT,
+  KEY_TTL,
+  KEY_OP,
+  KEY_ARGS,
+  KEY_CALLBACK,
+  KEY_CONTEXT,
+  KEY_PID,
+  KEY_LENGTH
+};
+
+static const char *bindings_key_names[] = {
+  "dev", "ino", "mode", "nlink", "uid", "gid", "rdev", "size", "blocks", "blksize", "mtime", "ctime", "atime",
+  "bsize", "frsize", "bfree", "bavail", "files", "ffree", "favail", "fsid", "flag", "namemax",
+  "name", "stat", "ttl", "op", "args", "callback", "context", "pid"
+};
+
+// v8 handles belong to one isolate, and every worker thread that loads us has
+// its own. so the handles are per thread and get allocated in Init
+static thread_local Nan::Persistent<String> *bindings_keys;
 
 enum bindings_ops_t {
   OP_INIT = 0,
@@ -70,29 +146,213 @@ enum bindings_ops_t {
   OP_SYMLINK,
   OP_MKDIR,
   OP_RMDIR,
-  OP_DESTROY
+  OP_DESTROY,
+  OP_LOOKUP,
+  OP_FORGET,
+  OP_SETATTR,
+  OP_LENGTH
 };
 
-static Nan::Persistent<Function> buffer_constructor;
-static Nan::Callback *callback_constructor;
-static struct FUSE_STAT empty_stat;
+// js names of the ops above, in the same order
+static const char *bindings_op_names[] = {
+  "init", "error", "access", "statfs", "fgetattr", "getattr", "flush", "fsync", "fsyncdir", "readdir",
+  "truncate", "ftruncate", "utimens", "readlink", "chown", "chmod", "mknod", "setxattr", "getxattr",
+  "listxattr", "removexattr", "open", "opendir", "read", "write", "release", "releasedir", "create",
+  "unlink", "rename", "link", "symlink", "mkdir", "rmdir", "destroy", "lookup", "forget", "setattr"
+};
 
-struct bindings_t {
-  int index;
-  int gc;
+static thread_local Nan::Persistent<String> *bindings_op_strings;
+
+#define BINDINGS_MAX_REQUESTS 1024
+#define BINDINGS_DEFAULT_REQUESTS 64
+#define BINDINGS_ATTR_CACHE_SIZE 65536
+#define BINDINGS_COPY_THRESHOLD 32768
+#define BINDINGS_INTERN_SIZE 4096
+#define BINDINGS_BLOCK_CACHE_SIZE (64 * 1024 * 1024)
+#define BINDINGS_BLOCK_SIZE (128 * 1024)
+#define BINDINGS_WRITE_BEHIND_SIZE (128 * 1024)
+#define BINDINGS_WRITE_BEHIND_AGE 1000
+#define BINDINGS_READAHEAD_SIZE (1024 * 1024)
+#define BINDINGS_READAHEAD_CHUNK (128 * 1024)
+#define BINDINGS_READAHEAD_TRIGGER 2 // reads in a row that continue the previous one
+
+static thread_local Nan::Persistent<Function> *buffer_constructor;
+static thread_local Nan::Callback *callback_constructor;
+static thread_local Nan::Callback *slice_constructor;
+
+// the loop of the isolate we're called from, the main one unless in a worker
+#if defined(NAN_MODULE_WORKER_ENABLED)
+#define BINDINGS_LOOP Nan::GetCurrentEventLoop()
+#else
+#define BINDINGS_LOOP uv_default_loop()
+#endif
+
+struct bindings_t;
+struct bindings_attr_cache_t;
+struct bindings_block_cache_t;
+struct bindings_write_behind_t;
+struct bindings_write_buffer_t;
+struct bindings_readahead_t;
+struct bindings_stream_t;
+struct bindings_intern_t;
+
+// native state of an open file in the path based backend, info->fh points to it
+struct bindings_file_t {
+  uint64_t fh; // fh returned by the js open or create
+  int backing_fd; // writes go straight to this fd, -1 if not set
+  int passthrough_fd; // all io is served natively from this fd, -1 if not set
+  bindings_write_buffer_t *buffer; // write behind buffer, NULL if not used
+  bindings_stream_t *stream; // read-ahead state, NULL if not used
+};
+
+NAN_INLINE static int bindings_passthrough_fd (struct fuse_file_info *info) {
+  return info == NULL ? -1 : ((bindings_file_t *) info->fh)->passthrough_fd;
+}
+
+NAN_INLINE static bindings_write_buffer_t *bindings_file_buffer (struct fuse_file_info *info) {
+  return info == NULL ? NULL : ((bindings_file_t *) info->fh)->buffer;
+}
+
+NAN_INLINE static bindings_stream_t *bindings_file_stream (struct fuse_file_info *info) {
+  return info == NULL ? NULL : ((bindings_file_t *) info->fh)->stream;
+}
+
+// a readdir entry, stat is empty unless js passed one along
+struct bindings_dirent_t {
+  std::string name;
+  struct FUSE_STAT stat;
+};
+
+// native state of a directory opened in paged readdir mode, info->fh points to it.
+// entries holds the names from base onwards that the kernel has not consumed yet
+struct bindings_dir_t {
+  uint64_t fh; // fh returned by the js opendir
+  double cookie; // js offset of the next chunk
+  int eof;
+  FUSE_OFF_T base;
+  std::deque<bindings_dirent_t> entries;
+};
+
+// one in-flight fuse operation. the fuse thread that issued it blocks on
+// done until the js callback bound to its id completes it
+struct bindings_req_t {
+  int id;
+  bindings_t *b;
+  bindings_completion_t done;
+  Nan::Callback *callback;
+  int inflight; // js has the callback of the current op and hasn't called it yet, loop thread only
+
+  // pooled js buffer small reads and writes are staged in, only touched on the loop thread
+  Nan::Persistent<Object> pool;
+  char *pool_data;
+  Nan::Persistent<Object> pool_view; // slice of pool, reused while the length stays the same
+  size_t pool_view_length;
+  int pooled; // the current op is using the pool
 
   // fuse context
   int context_uid;
   int context_gid;
   int context_pid;
 
+  // method data
+  bindings_ops_t op;
+  fuse_fill_dir_t filler; // used in readdir
+  struct fuse_file_info *info;
+  char *path;
+  char *name;
+  FUSE_OFF_T offset;
+  FUSE_OFF_T length;
+  void *data; // various structs
+  int mode;
+  int dev;
+  int uid;
+  int gid;
+  int result;
+  int fd; // read answered with a file descriptor instead of the buffer, -1 if not
+  FUSE_OFF_T fd_offset;
+  uint64_t cache_generation; // attr cache generation when a getattr was issued
+
+  // uv_hrtime stamps of the phases, only set when stats or tracing are enabled
+  uint64_t time_enter; // 0 if this request isn't timed
+  uint64_t time_send;
+  uint64_t time_dispatch;
+  uint64_t time_callback; // 0 if no js callback was involved
+
+  // set for requests nobody waits on, called on the loop thread instead of waking the issuer
+  void (*complete)(bindings_req_t *req);
+  void *complete_data;
+
+  // lowlevel method data
+  uint64_t ino; // inode (or parent inode) the op targets
+  uint64_t ino2; // new parent inode for rename and link
+#ifndef _WIN32
+  fuse_req_t fuse_req;
+#endif
+};
+
+// bounded lock-free queue (vyukov). used both as the mpsc queue of pending
+// requests and as the pool of free request slots
+struct bindings_ring_cell_t {
+  std::atomic<size_t> sequence;
+  bindings_req_t *req;
+};
+
+struct bindings_ring_t {
+  bindings_ring_cell_t *cells;
+  size_t mask;
+  std::atomic<size_t> head;
+  std::atomic<size_t> tail;
+};
+
+struct bindings_t {
+  int index;
+  int gc;
+  int multithread;
+  int lowlevel;
+  int readdir_paged;
+  int spin;
+  size_t copy_threshold;
+
   // fuse data
   char mnt[1024];
   char mntopts[1024];
   abstr_thread_t thread;
-  bindings_sem_t semaphore;
-  bindings_sem_t semaphore_readdir;
   uv_async_t async;
+  struct fuse_chan *ch; // set while the lowlevel session runs, notifications go through it
+  int notifying; // notifications using ch right now, guarded by mutex
+  bindings_completion_t notified; // signalled when notifying drops to 0 after ch is gone
+
+  // request slots
+  bindings_sem_t reqs_available;
+  bindings_req_t *reqs;
+  int reqs_length;
+  bindings_ring_t *reqs_free;
+  bindings_ring_t *pending;
+
+  // worker threads the requests are sharded across, see bindings_shard. a shard
+  // is a bindings_t of its own, only with request slots and js handlers
+  bindings_t **shards;
+  int shards_length;
+  int shard;
+  bindings_t *primary; // the mount a shard serves, NULL until it is mounted
+  int closing; // shards close their async once set, guarded by mutex
+  std::atomic<int> gone; // the shard's worker exited, set under mutex, see bindings_shard_cleanup
+  int closed; // the async of a gone shard is closed, the mount frees the rest. guarded by mutex
+
+  // native caches, NULL when disabled
+  bindings_attr_cache_t *attr_cache;
+  bindings_block_cache_t *block_cache;
+  bindings_write_behind_t *write_behind;
+  bindings_readahead_t *readahead;
+  bindings_intern_t *intern;
+  bindings_op_stats_t *stats; // OP_LENGTH entries
+  bindings_trace_t *trace;
+
+#ifndef _WIN32
+  // native handlers from ops.plugin, NULL when not set
+  struct fuse_bindings_plugin *plugin;
+  void *plugin_handle;
+#endif
 
   // methods
   Nan::Callback *ops_init;
@@ -131,27 +391,32 @@ struct bindings_t {
   Nan::Callback *ops_rmdir;
   Nan::Callback *ops_destroy;
 
-  Nan::Callback *callback;
+  // lowlevel only methods
+  Nan::Callback *ops_lookup;
+  Nan::Callback *ops_forget;
+  Nan::Callback *ops_setattr;
 
-  // method data
-  bindings_ops_t op;
-  fuse_fill_dir_t filler; // used in readdir
-  struct fuse_file_info *info;
-  char *path;
-  char *name;
-  FUSE_OFF_T offset;
-  FUSE_OFF_T length;
-  void *data; // various structs
-  int mode;
-  int dev;
-  int uid;
-  int gid;
-  int result;
+  // ops in batch_ops are handed to ops_batch together instead of one call each
+  Nan::Callback *ops_batch;
+  uint64_t batch_ops;
 };
 
-static bindings_t *bindings_mounted[1024];
+// read without the mutex by OpCallback, on whichever thread the op's handlers live
+static std::atomic<bindings_t *> bindings_mounted[1024];
 static int bindings_mounted_count = 0;
-static bindings_t *bindings_current = NULL;
+static thread_local bindings_req_t *bindings_current = NULL;
+static thread_local Local<Array> *bindings_batch = NULL; // set while bindings_dispatch collects a batch
+
+// a kernel answer to fuse.notify.retrieve, handed to the waiting NotifyWorker
+struct bindings_retrieve_t {
+  bindings_t *b;
+  bindings_completion_t done;
+  char *data;
+  size_t length;
+  int result;
+};
+
+static std::unordered_set<bindings_retrieve_t *> bindings_retrieves; // waiting for the kernel, guarded by mutex
 
 static bindings_t *bindings_find_mounted (char *path) {
   for (int i = 0; i < bindings_mounted_count; i++) {
@@ -167,21 +432,99 @@ static int bindings_fusermount (char *path) {
   return fusermount(path);
 }
 
-static int bindings_unmount (char *path) {
-  mutex_lock(&mutex);
-  bindings_t *b = bindings_find_mounted(path);
-  int result = bindings_fusermount(path);
-  if (b != NULL && result == 0) b->gc = 1;
-  mutex_unlock(&mutex);
+#ifndef _WIN32
+// fusermount exits with 1 whatever went wrong, so the reason is read off the mount
+// table instead. the mount itself isn't touched, its filesystem may not answer
+static int bindings_fusermount_error (const char *path, int err) {
+#if defined(__APPLE__)
+  return err;
+#else
+  FILE *mounts = setmntent("/proc/self/mounts", "r");
+  if (mounts == NULL) return err;
+
+  // fuse mounts carry the uid of whoever mounted them, only they may unmount
+  char owner[32];
+  snprintf(owner, sizeof(owner), "user_id=%u", (unsigned) getuid());
 
-  if (b != NULL && result == 0) thread_join(b->thread);
+  int result = EINVAL;
+  struct mntent *entry;
+  while ((entry = getmntent(mounts)) != NULL) {
+    if (!strcmp(entry->mnt_dir, path)) result = hasmntopt(entry, owner) != NULL ? EBUSY : EPERM;
+  }
+  endmntent(mounts);
 
+  if (result == EINVAL && access(path, F_OK) == -1) result = errno;
   return result;
+#endif
+}
+#endif
+
+// unmount in-process. on linux a mount with files still open on it is detached
+// lazily (and *lazy set), osx has no lazy unmount so it fails with EBUSY there.
+// only unprivileged linux processes get EPERM here and have to fork fusermount
+static int bindings_detach (char *path, int *lazy) {
+  *lazy = 0;
+#if defined(_WIN32)
+  return bindings_fusermount(path) == 0 ? 0 : EIO;
+#else
+#if defined(__APPLE__)
+  int result = unmount(path, 0);
+#else
+  int result = umount2(path, 0);
+  if (result == -1 && errno == EBUSY) {
+    result = umount2(path, MNT_DETACH);
+    *lazy = result == 0;
+  }
+#endif
+  if (result == 0) return 0;
+  int err = errno;
+  if (err != EPERM) return err;
+  return bindings_fusermount(path) == 0 ? 0 : bindings_fusermount_error(path, err);
+#endif
+}
+
+// detaches every path first and then waits for their fuse threads, so tearing
+// down many mounts costs about as much as the slowest one. results are -errno.
+// a lazily detached mount is only done once its last file is closed, which
+// may be never, so its thread isn't waited for
+static void bindings_unmount (std::vector<std::string> &paths, std::vector<int> &results) {
+  std::vector<abstr_thread_t> threads;
+
+  for (size_t i = 0; i < paths.size(); i++) {
+    char *path = (char *) paths[i].c_str();
+
+    // claim the mount so a concurrent unmount of the same path doesn't join it too
+    mutex_lock(&mutex);
+    bindings_t *b = bindings_find_mounted(path);
+    abstr_thread_t thread;
+    if (b != NULL) {
+      b->gc = 1;
+      thread = b->thread;
+    }
+    mutex_unlock(&mutex);
+
+    int lazy;
+    results[i] = -bindings_detach(path, &lazy);
+
+    if (b == NULL) continue;
+    if (results[i] == 0) {
+      if (lazy) thread_detach(thread);
+      else threads.push_back(thread);
+      continue;
+    }
+
+    // still mounted so b is still alive, unless it went away on its own meanwhile
+    mutex_lock(&mutex);
+    if (bindings_mounted[b->index] == b) b->gc = 0;
+    mutex_unlock(&mutex);
+  }
+
+  for (size_t i = 0; i < threads.size(); i++) thread_join(threads[i]);
 }
 
 #if (NODE_MODULE_VERSION > NODE_0_10_MODULE_VERSION && NODE_MODULE_VERSION < IOJS_3_0_MODULE_VERSION)
 NAN_INLINE v8::Local<v8::Object> bindings_buffer (char *data, size_t length) {
-  Local<Object> buf = Nan::New(buffer_constructor)->NewInstance(0, NULL);
+  Local<Object> buf = Nan::New(*buffer_constructor)->NewInstance(0, NULL);
   Local<String> k = LOCAL_STRING("length");
   Local<Number> v = Nan::New<Number>(length);
   buf->Set(k, v);
@@ -195,420 +538,2763 @@ NAN_INLINE v8::Local<v8::Object> bindings_buffer (char *data, size_t length) {
 }
 #endif
 
-NAN_INLINE static int bindings_call_ex (bindings_t *b, bool isreaddir) {
-  uv_async_send(&(b->async));
-  if (isreaddir) {
-    semaphore_wait(&(b->semaphore_readdir));  
-  } else {
-    semaphore_wait(&(b->semaphore));  
-  }
+static bindings_ring_t *bindings_ring_new (size_t size) {
+  size_t capacity = 1;
+  while (capacity < size) capacity <<= 1;
 
-  return b->result;
-}
+  bindings_ring_t *ring = new bindings_ring_t();
+  ring->cells = new bindings_ring_cell_t[capacity];
+  ring->mask = capacity - 1;
+  ring->head.store(0);
+  ring->tail.store(0);
+  for (size_t i = 0; i < capacity; i++) ring->cells[i].sequence.store(i);
 
-NAN_INLINE static int bindings_call (bindings_t *b) {
-  return bindings_call_ex(b, false);
+  return ring;
 }
 
-static bindings_t *bindings_get_context () {
-  fuse_context *ctx = fuse_get_context();
-  bindings_t *b = (bindings_t *) ctx->private_data;
-  b->context_pid = ctx->pid;
-  b->context_uid = ctx->uid;
-  b->context_gid = ctx->gid;
-  return b;
+static void bindings_ring_destroy (bindings_ring_t *ring) {
+  delete[] ring->cells;
+  delete ring;
 }
 
-static int bindings_mknod (const char *path, mode_t mode, dev_t dev) {
-  bindings_t *b = bindings_get_context();
+// never fails as the ring is sized for every request slot of the mount
+static void bindings_ring_push (bindings_ring_t *ring, bindings_req_t *req) {
+  size_t pos = ring->head.load(std::memory_order_relaxed);
 
-  b->op = OP_MKNOD;
-  b->path = (char *) path;
-  b->mode = mode;
-  b->dev = dev;
+  while (true) {
+    bindings_ring_cell_t *cell = ring->cells + (pos & ring->mask);
+    size_t seq = cell->sequence.load(std::memory_order_acquire);
 
-  return bindings_call(b);
+    if (seq == pos) {
+      if (ring->head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        cell->req = req;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return;
+      }
+    } else {
+      pos = ring->head.load(std::memory_order_relaxed);
+    }
+  }
 }
 
-static int bindings_truncate (const char *path, FUSE_OFF_T size) {
-  bindings_t *b = bindings_get_context();
+static bindings_req_t *bindings_ring_shift (bindings_ring_t *ring) {
+  size_t pos = ring->tail.load(std::memory_order_relaxed);
 
-  b->op = OP_TRUNCATE;
-  b->path = (char *) path;
-  b->length = size;
+  while (true) {
+    bindings_ring_cell_t *cell = ring->cells + (pos & ring->mask);
+    size_t seq = cell->sequence.load(std::memory_order_acquire);
+    intptr_t diff = (intptr_t) seq - (intptr_t) (pos + 1);
 
-  return bindings_call(b);
+    if (diff == 0) {
+      if (ring->tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        bindings_req_t *req = cell->req;
+        cell->sequence.store(pos + ring->mask + 1, std::memory_order_release);
+        return req;
+      }
+    } else if (diff < 0) {
+      return NULL;
+    } else {
+      pos = ring->tail.load(std::memory_order_relaxed);
+    }
+  }
 }
 
-static int bindings_ftruncate (const char *path, FUSE_OFF_T size, struct fuse_file_info *info) {
-  bindings_t *b = bindings_get_context();
+NAN_INLINE static bool bindings_timed (bindings_t *b) {
+  return b->stats != NULL || bindings_tracing(b->trace);
+}
 
-  b->op = OP_FTRUNCATE;
-  b->path = (char *) path;
-  b->length = size;
-  b->info = info;
+static bindings_req_t *bindings_req_alloc (bindings_t *b) {
+  uint64_t enter = bindings_timed(b) ? uv_hrtime() : 0;
+  semaphore_wait(&(b->reqs_available));
+
+  // a concurrent free may have claimed an earlier cell without publishing it yet
+  bindings_req_t *req;
+  while ((req = bindings_ring_shift(b->reqs_free)) == NULL) cpu_relax();
+
+  completion_reset(&(req->done));
+  req->time_enter = enter;
+  req->info = NULL;
+  req->path = NULL;
+  req->name = NULL;
+  req->offset = 0;
+  req->length = 0;
+  req->ino = 0;
+  req->complete = NULL;
+  return req;
+}
 
-  return bindings_call(b);
+static void bindings_req_free (bindings_req_t *req) {
+  bindings_t *b = req->b;
+  bindings_ring_push(b->reqs_free, req);
+  semaphore_signal(&(b->reqs_available));
 }
 
-static int bindings_getattr (const char *path, struct FUSE_STAT *stat) {
-  bindings_t *b = bindings_get_context();
+static uint32_t bindings_hash (const char *str, size_t len) {
+  uint32_t hash = 2166136261u; // fnv-1a
+  for (size_t i = 0; i < len; i++) hash = (hash ^ (unsigned char) str[i]) * 16777619u;
+  return hash;
+}
 
-  b->op = OP_GETATTR;
-  b->path = (char *) path;
-  b->data = stat;
+NAN_INLINE static uint64_t bindings_file_fh (struct fuse_file_info *info) {
+  return ((bindings_file_t *) info->fh)->fh;
+}
 
-  return bindings_call(b);
+NAN_INLINE static uint64_t bindings_dir_fh (bindings_t *b, struct fuse_file_info *info) {
+  return b->readdir_paged ? ((bindings_dir_t *) info->fh)->fh : info->fh;
 }
 
-static int bindings_fgetattr (const char *path, struct FUSE_STAT *stat, struct fuse_file_info *info) {
-  bindings_t *b = bindings_get_context();
+// the fh js sees for the op, 0 if it has none
+static uint64_t bindings_req_fh (bindings_req_t *req) {
+  if (req->info == NULL) return 0;
+  if (req->b->lowlevel) return req->info->fh;
 
-  b->op = OP_FGETATTR;
-  b->path = (char *) path;
-  b->data = stat;
-  b->info = info;
+  switch (req->op) {
+    case OP_OPEN:
+    case OP_CREATE:
+    return ((bindings_file_t *) req->data)->fh;
 
-  return bindings_call(b);
-}
+    case OP_OPENDIR:
+    return req->info->fh;
 
-static int bindings_flush (const char *path, struct fuse_file_info *info) {
-  bindings_t *b = bindings_get_context();
+    case OP_READDIR:
+    case OP_RELEASEDIR:
+    case OP_FSYNCDIR:
+    return bindings_dir_fh(req->b, req->info);
 
-  b->op = OP_FLUSH;
-  b->path = (char *) path;
-  b->info = info;
+    default:
+    return bindings_file_fh(req->info);
+  }
+}
 
-  return bindings_call(b);
+static void bindings_trace_record (bindings_trace_t *trace, bindings_req_t *req, uint64_t callback, uint64_t now) {
+  const char *path = req->path != NULL ? req->path : req->name;
+  uint64_t index;
+  bindings_trace_event_t *event = bindings_trace_claim(trace, &index);
+
+  event->enter = req->time_enter;
+  event->send = req->time_send;
+  event->dispatch = req->time_dispatch;
+  event->callback = callback;
+  event->done = now;
+  event->op = req->op;
+  event->slot = req->id % BINDINGS_MAX_REQUESTS;
+  event->result = req->result;
+  event->pid = req->context_pid;
+  event->hash = path != NULL ? bindings_hash(path, strlen(path)) : 0;
+  event->ino = req->ino;
+  event->fh = bindings_req_fh(req);
+  event->offset = req->offset;
+  event->length = req->length;
+
+  bindings_trace_commit(event, index);
 }
 
-static int bindings_fsync (const char *path, int datasync, struct fuse_file_info *info) {
-  bindings_t *b = bindings_get_context();
+static void bindings_stats_record (bindings_op_stats_t *stats, bindings_req_t *req, uint64_t callback, uint64_t now) {
+  stats += req->op;
 
-  b->op = OP_FSYNC;
-  b->path = (char *) path;
-  b->mode = datasync;
-  b->info = info;
+  bindings_hist_record(stats->phases + PHASE_SEND, req->time_send - req->time_enter);
+  bindings_hist_record(stats->phases + PHASE_QUEUE, req->time_dispatch - req->time_send);
+  bindings_hist_record(stats->phases + PHASE_JS, callback - req->time_dispatch);
+  bindings_hist_record(stats->phases + PHASE_POST, now - callback);
+  bindings_hist_record(stats->phases + PHASE_TOTAL, now - req->time_enter);
 
-  return bindings_call(b);
+  if (req->result < 0) bindings_stats_error(stats, -req->result);
+  else if (req->op == OP_READ || req->op == OP_WRITE) stats->bytes.fetch_add(req->result, std::memory_order_relaxed);
 }
 
-static int bindings_fsyncdir (const char *path, int datasync, struct fuse_file_info *info) {
-  bindings_t *b = bindings_get_context();
+NAN_INLINE static void bindings_req_record (bindings_req_t *req) {
+  bindings_t *b = req->b->primary != NULL ? req->b->primary : req->b;
+  if (!req->time_enter) return;
 
-  b->op = OP_FSYNCDIR;
-  b->path = (char *) path;
-  b->mode = datasync;
-  b->info = info;
+  uint64_t now = uv_hrtime();
+  uint64_t callback = req->time_callback ? req->time_callback : req->time_dispatch;
 
-  return bindings_call(b);
+  if (b->stats != NULL) bindings_stats_record(b->stats, req, callback, now);
+  if (bindings_tracing(b->trace)) bindings_trace_record(b->trace, req, callback, now);
 }
 
-static int bindings_readdir (const char *path, void *buf, fuse_fill_dir_t filler, FUSE_OFF_T offset, struct fuse_file_info *info) {
-  bindings_t *b = bindings_get_context();
-
-  b->op = OP_READDIR;
-  b->path = (char *) path;
-  b->data = buf;
-  b->filler = filler;
-
-  return bindings_call_ex(b, true);
+// the shard a request is dispatched on, NULL for this thread. all ops on a path
+// (or inode) go to the same worker so they stay in order. init, error and
+// destroy drive index.js and stay on the thread that mounted
+// the native state of the open handle an op is on, 0 if it has none. unlike the
+// fh js returned it is unique per handle and stays the same across renames
+static uint64_t bindings_req_handle (bindings_req_t *req) {
+  if (req->info == NULL || req->b->lowlevel) return 0;
+
+  switch (req->op) {
+    case OP_OPEN:
+    case OP_CREATE:
+    case OP_OPENDIR:
+    return 0;
+
+    case OP_READDIR:
+    case OP_RELEASEDIR:
+    case OP_FSYNCDIR:
+    return req->b->readdir_paged ? req->info->fh : 0;
+
+    default:
+    return req->info->fh;
+  }
 }
 
-static int bindings_readlink (const char *path, char *buf, size_t len) {
-  bindings_t *b = bindings_get_context();
+// ops on an open handle go by the handle, so a rename can't move the rest of its
+// ops to another shard. the others by path, or by inode which never changes
+static bindings_t *bindings_shard (bindings_req_t *req) {
+  bindings_t *b = req->b;
+  if (b->shards_length == 0) return NULL;
+  if (req->op == OP_INIT || req->op == OP_ERROR || req->op == OP_DESTROY) return NULL;
+
+  uint64_t handle = bindings_req_handle(req);
+  uint32_t hash;
+  if (handle != 0) hash = (uint32_t) ((handle * 0x9e3779b97f4a7c15ULL) >> 32);
+  else if (req->path != NULL) hash = bindings_hash(req->path, strlen(req->path));
+  else hash = (uint32_t) ((req->ino * 0x9e3779b97f4a7c15ULL) >> 32);
+
+  // the next live shard takes over the paths of one whose worker exited
+  for (int i = 0; i < b->shards_length; i++) {
+    bindings_t *shard = b->shards[(hash + i) % b->shards_length];
+    if (!shard->gone.load(std::memory_order_relaxed)) return shard;
+  }
+  return b->shards[hash % b->shards_length];
+}
 
-  b->op = OP_READLINK;
-  b->path = (char *) path;
-  b->data = (void *) buf;
-  b->length = len;
+// copies the method data of req into a slot of the shard. req stays with the
+// fuse thread, so the op code reading it afterwards doesn't know the difference
+static bindings_req_t *bindings_shard_req (bindings_t *shard, bindings_req_t *req) {
+  bindings_req_t *fwd = bindings_req_alloc(shard);
+
+  fwd->context_uid = req->context_uid;
+  fwd->context_gid = req->context_gid;
+  fwd->context_pid = req->context_pid;
+  fwd->op = req->op;
+  fwd->filler = req->filler;
+  fwd->info = req->info;
+  fwd->path = req->path;
+  fwd->name = req->name;
+  fwd->offset = req->offset;
+  fwd->length = req->length;
+  fwd->data = req->data;
+  fwd->mode = req->mode;
+  fwd->dev = req->dev;
+  fwd->uid = req->uid;
+  fwd->gid = req->gid;
+  fwd->fd = req->fd;
+  fwd->fd_offset = req->fd_offset;
+  fwd->cache_generation = req->cache_generation;
+  fwd->ino = req->ino;
+  fwd->ino2 = req->ino2;
+#ifndef _WIN32
+  fwd->fuse_req = req->fuse_req;
+#endif
+  fwd->time_enter = req->time_enter;
+  fwd->time_send = req->time_send;
 
-  return bindings_call(b);
+  return fwd;
 }
 
-static int bindings_chown (const char *path, uid_t uid, gid_t gid) {
-  bindings_t *b = bindings_get_context();
+// false if the shard's worker is gone. the check and the push happen under the
+// mutex, so bindings_shard_cleanup sees every request that made it in
+static bool bindings_shard_send (bindings_t *shard, bindings_req_t *req) {
+  mutex_lock(&mutex);
+  bool gone = shard->gone.load(std::memory_order_relaxed);
+  if (!gone) {
+    bindings_ring_push(shard->pending, req);
+    uv_async_send(&(shard->async));
+  }
+  mutex_unlock(&mutex);
+  return !gone;
+}
 
-  b->op = OP_CHOWN;
-  b->path = (char *) path;
-  b->uid = uid;
-  b->gid = gid;
+static void bindings_shard_call (bindings_t *shard, bindings_req_t *req) {
+  bindings_req_t *fwd = bindings_shard_req(shard, req);
 
-  return bindings_call(b);
+  if (!bindings_shard_send(shard, fwd)) {
+    bindings_req_free(fwd);
+    req->result = -EIO;
+    req->time_dispatch = req->time_send;
+    req->time_callback = 0;
+    return;
+  }
+  completion_wait(&(fwd->done), req->b->spin);
+
+  req->result = fwd->result;
+  req->length = fwd->length; // lowlevel readdir
+  req->fd = fwd->fd;
+  req->fd_offset = fwd->fd_offset;
+  req->time_dispatch = fwd->time_dispatch;
+  req->time_callback = fwd->time_callback;
+  bindings_req_free(fwd);
 }
 
-static int bindings_chmod (const char *path, mode_t mode) {
-  bindings_t *b = bindings_get_context();
+NAN_INLINE static void bindings_call_wait (bindings_req_t *req) {
+  bindings_t *b = req->b;
+
+  if (req->time_enter) req->time_send = uv_hrtime();
+
+  bindings_t *shard = bindings_shard(req);
+  if (shard != NULL) {
+    bindings_shard_call(shard, req);
+    bindings_req_record(req);
+    return;
+  }
 
-  b->op = OP_CHMOD;
-  b->path = (char *) path;
-  b->mode = mode;
+  // uv_async_send coalesces, so the dispatcher drains the whole ring per wakeup
+  bindings_ring_push(b->pending, req);
+  uv_async_send(&(b->async));
+  completion_wait(&(req->done), b->spin);
 
-  return bindings_call(b);
+  bindings_req_record(req);
 }
 
-#ifdef __APPLE__
-static int bindings_setxattr (const char *path, const char *name, const char *value, size_t size, int flags, uint32_t position) {
-  bindings_t *b = bindings_get_context();
+// queues the request without waiting, complete gets it once js answered and has to free it
+NAN_INLINE static void bindings_call_async (bindings_req_t *req, void (*complete)(bindings_req_t *req), void *data) {
+  bindings_t *b = req->b;
 
-  b->op = OP_SETXATTR;
-  b->path = (char *) path;
-  b->name = (char *) name;
-  b->data = (void *) value;
-  b->length = size;
-  b->offset = position;
-  b->mode = flags;
+  if (req->time_enter) req->time_send = uv_hrtime();
 
-  return bindings_call(b);
-}
+  req->complete = complete;
+  req->complete_data = data;
 
-static int bindings_getxattr (const char *path, const char *name, char *value, size_t size, uint32_t position) {
-  bindings_t *b = bindings_get_context();
+  // complete gets the shard's slot then, which is the one it has to free
+  bindings_t *shard = bindings_shard(req);
+  if (shard != NULL) {
+    bindings_req_t *fwd = bindings_shard_req(shard, req);
+    fwd->complete = complete;
+    fwd->complete_data = data;
+    bindings_req_free(req);
 
-  b->op = OP_GETXATTR;
-  b->path = (char *) path;
-  b->name = (char *) name;
-  b->data = (void *) value;
-  b->length = size;
-  b->offset = position;
+    if (!bindings_shard_send(shard, fwd)) {
+      fwd->result = -EIO;
+      complete(fwd);
+    }
+    return;
+  }
 
-  return bindings_call(b);
+  bindings_ring_push(b->pending, req);
+  uv_async_send(&(b->async));
 }
-#else
-static int bindings_setxattr (const char *path, const char *name, const char *value, size_t size, int flags) {
-  bindings_t *b = bindings_get_context();
 
-  b->op = OP_SETXATTR;
-  b->path = (char *) path;
-  b->name = (char *) name;
-  b->data = (void *) value;
-  b->length = size;
-  b->offset = 0;
-  b->mode = flags;
+NAN_INLINE static int bindings_call (bindings_req_t *req) {
+  bindings_call_wait(req);
 
-  return bindings_call(b);
+  int result = req->result;
+  bindings_req_free(req);
+  return result;
 }
 
-static int bindings_getxattr (const char *path, const char *name, char *value, size_t size) {
-  bindings_t *b = bindings_get_context();
+#ifdef BINDINGS_HAS_BUFVEC
+// the copy of a js read fd that bindings_read_buf handed to libfuse. libfuse only
+// splices from it after read_buf returns and can't tell us when it is done, but it
+// replies before the thread takes another request, so the fd is closed on the next
+// op of the same thread, or when the thread exits
+struct bindings_spliced_fd_t {
+  int fd;
 
-  b->op = OP_GETXATTR;
-  b->path = (char *) path;
-  b->name = (char *) name;
-  b->data = (void *) value;
-  b->length = size;
-  b->offset = 0;
+  bindings_spliced_fd_t () : fd(-1) {}
+  ~bindings_spliced_fd_t () { if (fd > -1) close(fd); }
+};
 
-  return bindings_call(b);
-}
+static thread_local bindings_spliced_fd_t bindings_spliced_fd;
 #endif
 
-static int bindings_listxattr (const char *path, char *list, size_t size) {
-  bindings_t *b = bindings_get_context();
-
-  b->op = OP_LISTXATTR;
-  b->path = (char *) path;
-  b->data = (void *) list;
-  b->length = size;
-
-  return bindings_call(b);
+static bindings_req_t *bindings_get_context () {
+#ifdef BINDINGS_HAS_BUFVEC
+  if (bindings_spliced_fd.fd > -1) {
+    close(bindings_spliced_fd.fd);
+    bindings_spliced_fd.fd = -1;
+  }
+#endif
+  fuse_context *ctx = fuse_get_context();
+  bindings_req_t *req = bindings_req_alloc((bindings_t *) ctx->private_data);
+  req->context_pid = ctx->pid;
+  req->context_uid = ctx->uid;
+  req->context_gid = ctx->gid;
+  return req;
 }
 
-static int bindings_removexattr (const char *path, const char *name) {
-  bindings_t *b = bindings_get_context();
+NAN_INLINE static bindings_t *bindings_get_mount () {
+  return (bindings_t *) fuse_get_context()->private_data;
+}
 
-  b->op = OP_REMOVEXATTR;
-  b->path = (char *) path;
-  b->name = (char *) name;
+#ifndef _WIN32
+// whether the plugin of b has its own handler for op, see plugin.h
+#define BINDINGS_PLUGIN_HAS(b, op) ((b)->plugin != NULL && (b)->plugin->op != NULL)
+#else
+#define BINDINGS_PLUGIN_HAS(b, op) 0
+#endif
 
-  return bindings_call(b);
+NAN_INLINE static uint64_t bindings_now () {
+  return uv_hrtime() / 1000000;
 }
 
-static int bindings_statfs (const char *path, struct statvfs *statfs) {
-  bindings_t *b = bindings_get_context();
-  
-  b->op = OP_STATFS;
-  b->path = (char *) path;
-  b->data = statfs;
+// getattr results (and ENOENTs) keyed by path, so repeated stats can be
+// answered on the fuse thread. entries only get in here with a ttl from js,
+// least recently used ones go first when the cache is full
+#define BINDINGS_ATTR_BUCKETS 256
 
-  return bindings_call(b);
-}
+typedef std::list<const std::string *>::iterator bindings_attr_ref_t;
 
-static int bindings_open (const char *path, struct fuse_file_info *info) {
-  bindings_t *b = bindings_get_context();
+struct bindings_attr_entry_t {
+  uint64_t expires;
+  int result;
+  struct FUSE_STAT stat;
+  bindings_attr_ref_t lru;
+};
 
-  b->op = OP_OPEN;
-  b->path = (char *) path;
-  b->mode = info->flags;
-  b->info = info;
+typedef std::unordered_map<std::string, bindings_attr_entry_t>::iterator bindings_attr_iterator_t;
+
+struct bindings_attr_cache_t {
+  bindings_mutex_t lock;
+  // bumped by every invalidation. a getattr issued at generation g can't add its result
+  // if the path hash bucket (or everything, for a recursive one) was invalidated after g
+  uint64_t generation;
+  uint64_t invalidated[BINDINGS_ATTR_BUCKETS];
+  uint64_t invalidated_all;
+  size_t max;
+  std::list<const std::string *> lru; // keys of entries, most recently used first
+  std::unordered_map<std::string, bindings_attr_entry_t> entries;
+};
 
-  return bindings_call(b);
+#define BINDINGS_INVALIDATE_CHILDREN 1
+#define BINDINGS_INVALIDATE_PARENT 2
+
+static bindings_attr_cache_t *bindings_attr_cache_new (size_t max) {
+  bindings_attr_cache_t *cache = new bindings_attr_cache_t();
+  mutex_init(&(cache->lock));
+  cache->generation = 0;
+  for (int i = 0; i < BINDINGS_ATTR_BUCKETS; i++) cache->invalidated[i] = 0;
+  cache->invalidated_all = 0;
+  cache->max = max;
+  return cache;
 }
 
-static int bindings_opendir (const char *path, struct fuse_file_info *info) {
-  bindings_t *b = bindings_get_context();
-
-  b->op = OP_OPENDIR;
-  b->path = (char *) path;
-  b->mode = info->flags;
-  b->info = info;
+NAN_INLINE static uint64_t *bindings_attr_cache_bucket (bindings_attr_cache_t *cache, const char *path, size_t len) {
+  return cache->invalidated + (bindings_hash(path, len) % BINDINGS_ATTR_BUCKETS);
+}
 
-  return bindings_call(b);
+static bindings_attr_iterator_t bindings_attr_cache_erase (bindings_attr_cache_t *cache, bindings_attr_iterator_t it) {
+  cache->lru.erase(it->second.lru);
+  return cache->entries.erase(it);
 }
 
-static int bindings_read (const char *path, char *buf, size_t len, FUSE_OFF_T offset, struct fuse_file_info *info) {
-  bindings_t *b = bindings_get_context();
+static bool bindings_attr_cache_get (bindings_attr_cache_t *cache, const char *path, struct FUSE_STAT *stat, int *result) {
+  bool found = false;
+
+  mutex_lock(&(cache->lock));
+  bindings_attr_iterator_t it = cache->entries.find(path);
+  if (it != cache->entries.end()) {
+    if (it->second.expires > bindings_now()) {
+      *result = it->second.result;
+      if (!it->second.result) memcpy(stat, &(it->second.stat), sizeof(struct FUSE_STAT));
+      cache->lru.splice(cache->lru.begin(), cache->lru, it->second.lru);
+      found = true;
+    } else {
+      bindings_attr_cache_erase(cache, it);
+    }
+  }
+  mutex_unlock(&(cache->lock));
 
-  b->op = OP_READ;
-  b->path = (char *) path;
-  b->data = (void *) buf;
-  b->offset = offset;
-  b->length = len;
-  b->info = info;
+  return found;
+}
 
-  return bindings_call(b);
+static uint64_t bindings_attr_cache_generation (bindings_attr_cache_t *cache) {
+  mutex_lock(&(cache->lock));
+  uint64_t generation = cache->generation;
+  mutex_unlock(&(cache->lock));
+  return generation;
 }
 
-static int bindings_write (const char *path, const char *buf, size_t len, FUSE_OFF_T offset, struct fuse_file_info * info) {
-  bindings_t *b = bindings_get_context();
+static void bindings_attr_cache_set (bindings_attr_cache_t *cache, const char *path, struct FUSE_STAT *stat, int result, uint64_t ttl, uint64_t generation) {
+  uint64_t now = bindings_now();
+  uint64_t *bucket = bindings_attr_cache_bucket(cache, path, strlen(path));
+
+  mutex_lock(&(cache->lock));
+  if (*bucket <= generation && cache->invalidated_all <= generation) {
+    bindings_attr_iterator_t it = cache->entries.find(path);
 
-  b->op = OP_WRITE;
-  b->path = (char *) path;
-  b->data = (void *) buf;
-  b->offset = offset;
-  b->length = len;
-  b->info = info;
+    if (it == cache->entries.end()) {
+      if (cache->entries.size() >= cache->max && !cache->lru.empty()) {
+        bindings_attr_cache_erase(cache, cache->entries.find(*(cache->lru.back())));
+      }
+      it = cache->entries.insert(std::make_pair(std::string(path), bindings_attr_entry_t())).first;
+      cache->lru.push_front(&(it->first));
+      it->second.lru = cache->lru.begin();
+    } else {
+      cache->lru.splice(cache->lru.begin(), cache->lru, it->second.lru);
+    }
 
-  return bindings_call(b);
+    bindings_attr_entry_t &entry = it->second;
+    entry.expires = now + ttl;
+    entry.result = result;
+    if (stat != NULL) memcpy(&(entry.stat), stat, sizeof(struct FUSE_STAT));
+  }
+  mutex_unlock(&(cache->lock));
 }
 
-static int bindings_release (const char *path, struct fuse_file_info *info) {
-  bindings_t *b = bindings_get_context();
+static void bindings_attr_cache_invalidate (bindings_attr_cache_t *cache, const char *path, int flags) {
+  size_t len = strlen(path);
+  bindings_attr_iterator_t it;
 
-  b->op = OP_RELEASE;
-  b->path = (char *) path;
-  b->info = info;
+  mutex_lock(&(cache->lock));
+  uint64_t generation = ++cache->generation;
 
-  return bindings_call(b);
-}
+  *bindings_attr_cache_bucket(cache, path, len) = generation;
+  it = cache->entries.find(path);
+  if (it != cache->entries.end()) bindings_attr_cache_erase(cache, it);
 
-static int bindings_releasedir (const char *path, struct fuse_file_info *info) {
-  bindings_t *b = bindings_get_context();
+  if (flags & BINDINGS_INVALIDATE_PARENT) {
+    const char *slash = strrchr(path, '/');
+    if (slash != NULL) {
+      std::string parent = slash == path ? std::string("/") : std::string(path, slash - path);
+      *bindings_attr_cache_bucket(cache, parent.c_str(), parent.length()) = generation;
+      it = cache->entries.find(parent);
+      if (it != cache->entries.end()) bindings_attr_cache_erase(cache, it);
+    }
+  }
 
-  b->op = OP_RELEASEDIR;
-  b->path = (char *) path;
-  b->info = info;
+  if (flags & BINDINGS_INVALIDATE_CHILDREN) {
+    bool root = !strcmp(path, "/");
+    cache->invalidated_all = generation;
+    it = cache->entries.begin();
+    while (it != cache->entries.end()) {
+      const std::string &key = it->first;
+      if (root || (key.length() > len && key[len] == '/' && !key.compare(0, len, path))) it = bindings_attr_cache_erase(cache, it);
+      else it++;
+    }
+  }
+  mutex_unlock(&(cache->lock));
+}
 
-  return bindings_call(b);
+static void bindings_attr_cache_destroy (bindings_attr_cache_t *cache) {
+  delete cache;
 }
 
-static int bindings_access (const char *path, int mode) {
-  bindings_t *b = bindings_get_context();
+// file data in block_size blocks keyed by path, so repeat reads are answered on the
+// fuse thread. misses read the whole block from js, least recently used blocks go first
+struct bindings_block_t {
+  std::string path;
+  uint64_t index;
+  size_t length; // less than block_size for the last block of a file
+  char *data;
+};
 
-  b->op = OP_ACCESS;
-  b->path = (char *) path;
-  b->mode = mode;
+typedef std::list<bindings_block_t>::iterator bindings_block_ref_t;
 
-  return bindings_call(b);
+struct bindings_block_cache_t {
+  bindings_mutex_t lock;
+  uint64_t generation; // same as in the attr cache
+  size_t block_size;
+  size_t budget;
+  size_t used;
+  std::list<bindings_block_t> lru; // most recently used first
+  std::unordered_map<std::string, std::unordered_map<uint64_t, bindings_block_ref_t> > files;
+};
+
+static bindings_block_cache_t *bindings_block_cache_new (size_t budget, size_t block_size) {
+  bindings_block_cache_t *cache = new bindings_block_cache_t();
+  mutex_init(&(cache->lock));
+  cache->generation = 0;
+  cache->block_size = block_size;
+  cache->budget = budget;
+  cache->used = 0;
+  return cache;
 }
 
-static int bindings_create (const char *path, mode_t mode, struct fuse_file_info *info) {
-  bindings_t *b = bindings_get_context();
+static void bindings_block_cache_erase (bindings_block_cache_t *cache, bindings_block_ref_t block) {
+  cache->used -= block->length;
+  free(block->data);
+  cache->lru.erase(block);
+}
 
-  b->op = OP_CREATE;
-  b->path = (char *) path;
-  b->mode = mode;
-  b->info = info;
+// copies from offset within block index into out. false on a miss
+static bool bindings_block_cache_get (bindings_block_cache_t *cache, const char *path, uint64_t index, size_t offset, char *out, size_t len, size_t *copied, size_t *length) {
+  bool found = false;
+
+  mutex_lock(&(cache->lock));
+  std::unordered_map<std::string, std::unordered_map<uint64_t, bindings_block_ref_t> >::iterator file = cache->files.find(path);
+  if (file != cache->files.end()) {
+    std::unordered_map<uint64_t, bindings_block_ref_t>::iterator it = file->second.find(index);
+    if (it != file->second.end()) {
+      bindings_block_ref_t block = it->second;
+      *length = block->length;
+      *copied = offset < block->length ? std::min(block->length - offset, len) : 0;
+      memcpy(out, block->data + offset, *copied);
+      cache->lru.splice(cache->lru.begin(), cache->lru, block);
+      found = true;
+    }
+  }
+  mutex_unlock(&(cache->lock));
 
-  return bindings_call(b);
+  return found;
 }
 
-static int bindings_utimens (const char *path, const struct timespec tv[2]) {
-  bindings_t *b = bindings_get_context();
+static uint64_t bindings_block_cache_generation (bindings_block_cache_t *cache) {
+  mutex_lock(&(cache->lock));
+  uint64_t generation = cache->generation;
+  mutex_unlock(&(cache->lock));
+  return generation;
+}
 
-  b->op = OP_UTIMENS;
-  b->path = (char *) path;
-  b->data = (void *) tv;
+// takes over data, which must come from malloc
+static void bindings_block_cache_set (bindings_block_cache_t *cache, const char *path, uint64_t index, char *data, size_t length, uint64_t generation) {
+  mutex_lock(&(cache->lock));
+  std::unordered_map<uint64_t, bindings_block_ref_t> &file = cache->files[path];
 
-  return bindings_call(b);
-}
+  if (generation != cache->generation || length > cache->budget || file.count(index)) {
+    if (file.empty()) cache->files.erase(path);
+    mutex_unlock(&(cache->lock));
+    free(data);
+    return;
+  }
 
-static int bindings_unlink (const char *path) {
-  bindings_t *b = bindings_get_context();
+  while (cache->used + length > cache->budget && !cache->lru.empty()) {
+    bindings_block_ref_t last = --cache->lru.end();
+    std::unordered_map<std::string, std::unordered_map<uint64_t, bindings_block_ref_t> >::iterator owner = cache->files.find(last->path);
+    owner->second.erase(last->index);
+    if (owner->second.empty() && owner->first != path) cache->files.erase(owner);
+    bindings_block_cache_erase(cache, last);
+  }
 
-  b->op = OP_UNLINK;
-  b->path = (char *) path;
+  bindings_block_t block;
+  block.path = path;
+  block.index = index;
+  block.length = length;
+  block.data = data;
+  cache->lru.push_front(block);
+  cache->used += length;
+  file[index] = cache->lru.begin();
+  mutex_unlock(&(cache->lock));
+}
 
-  return bindings_call(b);
+static void bindings_block_cache_drop (bindings_block_cache_t *cache, std::unordered_map<std::string, std::unordered_map<uint64_t, bindings_block_ref_t> >::iterator file) {
+  std::unordered_map<uint64_t, bindings_block_ref_t>::iterator it;
+  for (it = file->second.begin(); it != file->second.end(); it++) bindings_block_cache_erase(cache, it->second);
 }
 
-static int bindings_rename (const char *src, const char *dest) {
-  bindings_t *b = bindings_get_context();
+static void bindings_block_cache_invalidate (bindings_block_cache_t *cache, const char *path, int flags) {
+  size_t len = strlen(path);
+
+  mutex_lock(&(cache->lock));
+  cache->generation++;
 
-  b->op = OP_RENAME;
-  b->path = (char *) src;
-  b->data = (void *) dest;
+  std::unordered_map<std::string, std::unordered_map<uint64_t, bindings_block_ref_t> >::iterator it = cache->files.find(path);
+  if (it != cache->files.end()) {
+    bindings_block_cache_drop(cache, it);
+    cache->files.erase(it);
+  }
 
-  return bindings_call(b);
+  if (flags & BINDINGS_INVALIDATE_CHILDREN) {
+    bool root = !strcmp(path, "/");
+    it = cache->files.begin();
+    while (it != cache->files.end()) {
+      const std::string &key = it->first;
+      if (root || (key.length() > len && key[len] == '/' && !key.compare(0, len, path))) {
+        bindings_block_cache_drop(cache, it);
+        it = cache->files.erase(it);
+      } else {
+        it++;
+      }
+    }
+  }
+  mutex_unlock(&(cache->lock));
 }
 
-static int bindings_link (const char *path, const char *dest) {
-  bindings_t *b = bindings_get_context();
+static void bindings_block_cache_destroy (bindings_block_cache_t *cache) {
+  for (bindings_block_ref_t it = cache->lru.begin(); it != cache->lru.end(); it++) free(it->data);
+  delete cache;
+}
 
-  b->op = OP_LINK;
-  b->path = (char *) path;
-  b->data = (void *) dest;
+// sequential readers get the data ahead of them asked from js before they need it.
+// chunks are read in the background into a window that later reads are served from
+#define BINDINGS_READAHEAD_BUCKETS 256
 
-  return bindings_call(b);
-}
+struct bindings_readahead_t {
+  size_t max; // largest window a stream grows to
+  std::atomic<uint32_t> generations[BINDINGS_READAHEAD_BUCKETS]; // bumped on invalidate, by path hash
+};
 
-static int bindings_symlink (const char *path, const char *dest) {
-  bindings_t *b = bindings_get_context();
+struct bindings_readahead_chunk_t {
+  bindings_stream_t *stream;
+  FUSE_OFF_T offset;
+  size_t length;
+  uint32_t generation; // of the path when the chunk was asked for
+  char *data;
+  int result; // bytes read or an error, once done
+  int done;
+  int cancelled; // dropped from the stream before js answered, freed when it does
+};
 
-  b->op = OP_SYMLINK;
-  b->path = (char *) path;
-  b->data = (void *) dest;
+struct bindings_stream_t {
+  uv_mutex_t lock;
+  uv_cond_t filled; // broadcast when a chunk is done
+  int refs; // the handle and every chunk in flight
+  int disabled; // js answered with a file descriptor, nothing to gain here
+
+  // what the background reads are issued with, the handle itself may be gone by then
+  std::string path;
+  bindings_file_t file;
+  struct fuse_file_info info;
+
+  FUSE_OFF_T next; // where the reader continues if it is sequential
+  int sequential;
+  size_t window; // bytes asked for ahead of the reader, doubles while the stream holds
+  FUSE_OFF_T ahead; // end of the last chunk asked for
+  FUSE_OFF_T eof; // where a short chunk ended, -1 if not seen
+  std::deque<bindings_readahead_chunk_t *> chunks; // by offset
+};
 
-  return bindings_call(b);
+static bindings_readahead_t *bindings_readahead_new (size_t max) {
+  bindings_readahead_t *readahead = new bindings_readahead_t();
+  readahead->max = max;
+  for (int i = 0; i < BINDINGS_READAHEAD_BUCKETS; i++) readahead->generations[i].store(0);
+  return readahead;
 }
 
-static int bindings_mkdir (const char *path, mode_t mode) {
-  bindings_t *b = bindings_get_context();
-
-  b->op = OP_MKDIR;
-  b->path = (char *) path;
-  b->mode = mode;
+NAN_INLINE static uint32_t bindings_readahead_generation (bindings_readahead_t *readahead, const char *path) {
+  return readahead->generations[bindings_hash(path, strlen(path)) % BINDINGS_READAHEAD_BUCKETS].load(std::memory_order_acquire);
+}
 
-  return bindings_call(b);
+static void bindings_readahead_invalidate (bindings_readahead_t *readahead, const char *path, int flags) {
+  if (flags & BINDINGS_INVALIDATE_CHILDREN) {
+    for (int i = 0; i < BINDINGS_READAHEAD_BUCKETS; i++) readahead->generations[i].fetch_add(1, std::memory_order_acq_rel);
+    return;
+  }
+  readahead->generations[bindings_hash(path, strlen(path)) % BINDINGS_READAHEAD_BUCKETS].fetch_add(1, std::memory_order_acq_rel);
 }
 
-static int bindings_rmdir (const char *path) {
-  bindings_t *b = bindings_get_context();
+static bindings_stream_t *bindings_stream_new (const char *path, bindings_file_t *file, struct fuse_file_info *info) {
+  bindings_stream_t *stream = new bindings_stream_t();
+  uv_mutex_init(&(stream->lock));
+  uv_cond_init(&(stream->filled));
+  stream->refs = 1;
+  stream->disabled = 0;
+  stream->path = path;
+  stream->file = *file;
+  stream->info = *info;
+  stream->info.fh = (uint64_t) &(stream->file);
+  stream->next = 0;
+  stream->sequential = 0;
+  stream->window = 2 * BINDINGS_READAHEAD_CHUNK;
+  stream->ahead = 0;
+  stream->eof = -1;
+  return stream;
+}
 
-  b->op = OP_RMDIR;
-  b->path = (char *) path;
+static void bindings_stream_unref (bindings_stream_t *stream) {
+  uv_mutex_lock(&(stream->lock));
+  bool last = --stream->refs == 0;
+  uv_mutex_unlock(&(stream->lock));
+  if (!last) return;
 
-  return bindings_call(b);
+  uv_cond_destroy(&(stream->filled));
+  uv_mutex_destroy(&(stream->lock));
+  delete stream;
 }
 
-static void* bindings_init (struct fuse_conn_info *conn) {
-  bindings_t *b = bindings_get_context();
+static void bindings_stream_drop_front (bindings_stream_t *stream) {
+  bindings_readahead_chunk_t *chunk = stream->chunks.front();
+  stream->chunks.pop_front();
 
-  b->op = OP_INIT;
+  if (chunk->done) {
+    free(chunk->data);
+    delete chunk;
+  } else {
+    chunk->cancelled = 1;
+  }
+}
 
-  bindings_call(b);
-  return b;
+// the reader seeked or the data changed, everything in the window is dropped
+static void bindings_stream_reset (bindings_stream_t *stream) {
+  while (!stream->chunks.empty()) bindings_stream_drop_front(stream);
+  stream->sequential = 0;
+  stream->window = 2 * BINDINGS_READAHEAD_CHUNK;
+  stream->ahead = 0;
+  stream->eof = -1;
 }
 
-static void bindings_destroy (void *data) {
-  bindings_t *b = bindings_get_context();
+static void bindings_stream_close (bindings_stream_t *stream) {
+  uv_mutex_lock(&(stream->lock));
+  bindings_stream_reset(stream);
+  uv_mutex_unlock(&(stream->lock));
+  bindings_stream_unref(stream);
+}
+
+// runs on the loop thread when js answers a background read
+static void bindings_stream_complete (bindings_req_t *req) {
+  bindings_readahead_chunk_t *chunk = (bindings_readahead_chunk_t *) req->complete_data;
+  bindings_stream_t *stream = chunk->stream;
+  int result = req->result;
+  bool fd = req->fd > -1;
+
+#ifndef _WIN32
+  if (fd) close(req->fd);
+#endif
+  bindings_req_record(req);
+  bindings_req_free(req);
 
-  b->op = OP_DESTROY;
+  uv_mutex_lock(&(stream->lock));
+  if (fd) {
+    stream->disabled = 1;
+    result = -EIO; // the reader asks js itself
+  }
+  chunk->result = result;
+  chunk->done = 1;
+
+  if (chunk->cancelled) {
+    free(chunk->data);
+    delete chunk;
+  } else if (result >= 0 && (size_t) result < chunk->length) {
+    stream->eof = chunk->offset + result;
+  }
+  // also wakes readers waiting on a chunk somebody else cancelled
+  uv_cond_broadcast(&(stream->filled));
+  uv_mutex_unlock(&(stream->lock));
 
-  bindings_call(b);
+  bindings_stream_unref(stream);
 }
 
-static void bindings_free (bindings_t *b) {
+// the bytes of an interned string. for ascii it is also the resource of the
+// external string v8 reads them from, so they are never copied into the heap
+class bindings_intern_string_t : public Nan::ExternalOneByteStringResource {
+ public:
+  bindings_intern_string_t (const char *str, size_t len) : str(str, len) {}
+  const char *data () const { return str.data(); }
+  size_t length () const { return str.length(); }
+  std::string str;
+};
+
+// direct mapped table of js strings for recently seen paths and names, only used on the loop thread
+struct bindings_intern_entry_t {
+  // external ones belong to v8, which keeps them until value is reset and js lets
+  // go of the string too, the others to the entry
+  bindings_intern_string_t *key;
+  bool external;
+  Nan::Persistent<String> value;
+
+  bindings_intern_entry_t () : key(NULL), external(false) {}
+};
+
+struct bindings_intern_t {
+  size_t mask;
+  bindings_intern_entry_t *entries;
+};
+
+static bindings_intern_t *bindings_intern_new (size_t size) {
+  size_t capacity = 1;
+  while (capacity < size) capacity <<= 1;
+
+  bindings_intern_t *intern = new bindings_intern_t();
+  intern->mask = capacity - 1;
+  intern->entries = new bindings_intern_entry_t[capacity];
+  return intern;
+}
+
+static void bindings_intern_entry_reset (bindings_intern_entry_t *entry) {
+  entry->value.Reset();
+  if (!entry->external) delete entry->key;
+  entry->key = NULL;
+}
+
+static void bindings_intern_destroy (bindings_intern_t *intern) {
+  for (size_t i = 0; i <= intern->mask; i++) bindings_intern_entry_reset(intern->entries + i);
+  delete[] intern->entries;
+  delete intern;
+}
+
+// ascii needs no utf8 decoding, it is copied into a one byte string as is
+static Local<String> bindings_new_string (const char *str, size_t len) {
+  if (!is_ascii(str, len)) return Nan::New<String>(str, len).ToLocalChecked();
+  return Nan::NewOneByteString((const uint8_t *) str, len).ToLocalChecked();
+}
+
+static Local<String> bindings_intern (bindings_t *b, const char *str) {
+  size_t len = strlen(str);
+  if (b->intern == NULL) return bindings_new_string(str, len);
+
+  uint32_t hash = bindings_hash(str, len);
+  bindings_intern_entry_t *entry = b->intern->entries + (hash & b->intern->mask);
+  if (entry->key != NULL && entry->key->str.length() == len && !memcmp(entry->key->str.data(), str, len)) {
+    return Nan::New(entry->value);
+  }
+
+  bindings_intern_entry_reset(entry);
+  entry->key = new bindings_intern_string_t(str, len);
+  // v8 disposes empty resources right away, so those stay with the entry
+  entry->external = len > 0 && is_ascii(str, len);
+
+  Local<String> value = entry->external
+    ? Nan::New<String>(entry->key).ToLocalChecked()
+    : Nan::New<String>(str, len).ToLocalChecked();
+  entry->value.Reset(value);
+  return value;
+}
+
+// called on the fuse thread after every op that can change attributes
+NAN_INLINE static void bindings_invalidate (bindings_t *b, const char *path, int flags) {
+  if (b->attr_cache != NULL) bindings_attr_cache_invalidate(b->attr_cache, path, flags);
+  if (b->block_cache != NULL) bindings_block_cache_invalidate(b->block_cache, path, flags);
+  if (b->readahead != NULL) bindings_readahead_invalidate(b->readahead, path, flags);
+}
+
+// small sequential writes to a handle are collected here and handed to js as one
+// write once the buffer is full, gets old or something else needs to see the data
+struct bindings_write_buffer_t {
+  bindings_mutex_t lock; // held by whoever is writing or flushing the buffer
+  struct fuse_file_info info; // copy of the handle's info from the first buffered write
+  char *data;
+  size_t length;
+  FUSE_OFF_T offset;
+  int error; // result of a failed background flush, returned by the next op on the handle
+  std::atomic<int64_t> end; // offset + length, read without the lock by getattr
+  int context_pid;
+  int context_uid;
+  int context_gid;
+  int refs; // one for the handle and one per flush that picked it from dirty, guarded by the write behind lock
+
+  // only changed while holding both locks
+  std::string path;
+  uint64_t since; // bindings_now() of the first buffered write, 0 while empty
+};
+
+typedef std::unordered_multimap<std::string, bindings_write_buffer_t *> bindings_dirty_buffers_t;
+
+struct bindings_write_behind_t {
+  bindings_mutex_t lock; // guards dirty and the refs of the buffers
+  size_t size;
+  uint64_t age; // ms
+  bindings_dirty_buffers_t dirty; // buffers with data in them, keyed by their path
+
+  // background thread flushing buffers older than age
+  abstr_thread_t thread;
+  uv_mutex_t wake_lock;
+  uv_cond_t wake;
+  int stopped;
+};
+
+static bindings_write_behind_t *bindings_write_behind_new (size_t size, uint64_t age) {
+  bindings_write_behind_t *wb = new bindings_write_behind_t();
+  mutex_init(&(wb->lock));
+  uv_mutex_init(&(wb->wake_lock));
+  uv_cond_init(&(wb->wake));
+  wb->size = size;
+  wb->age = age;
+  wb->stopped = 0;
+  return wb;
+}
+
+static void bindings_write_behind_destroy (bindings_write_behind_t *wb) {
+  uv_cond_destroy(&(wb->wake));
+  uv_mutex_destroy(&(wb->wake_lock));
+  delete wb;
+}
+
+static bindings_write_buffer_t *bindings_write_buffer_new (size_t size) {
+  bindings_write_buffer_t *buffer = new bindings_write_buffer_t();
+  mutex_init(&(buffer->lock));
+  buffer->data = (char *) malloc(size);
+  buffer->length = 0;
+  buffer->offset = 0;
+  buffer->error = 0;
+  buffer->end.store(0);
+  buffer->refs = 1;
+  buffer->since = 0;
+  return buffer;
+}
+
+// the last one to let go of a buffer frees it, a closed handle's buffer can still be held by a flush
+static void bindings_write_buffer_unref (bindings_write_behind_t *wb, bindings_write_buffer_t *buffer) {
+  mutex_lock(&(wb->lock));
+  bool last = --buffer->refs == 0;
+  mutex_unlock(&(wb->lock));
+  if (!last) return;
+
+  free(buffer->data);
+  delete buffer;
+}
+
+// the caller holds wb->lock
+static void bindings_write_behind_clean (bindings_write_behind_t *wb, bindings_write_buffer_t *buffer) {
+  std::pair<bindings_dirty_buffers_t::iterator, bindings_dirty_buffers_t::iterator> range = wb->dirty.equal_range(buffer->path);
+  for (bindings_dirty_buffers_t::iterator it = range.first; it != range.second; it++) {
+    if (it->second != buffer) continue;
+    wb->dirty.erase(it);
+    return;
+  }
+}
+
+// hands the buffered data to js, the caller holds buffer->lock
+static int bindings_write_buffer_flush (bindings_t *b, bindings_write_buffer_t *buffer) {
+  if (!buffer->length) return 0;
+
+  bindings_write_behind_t *wb = b->write_behind;
+  bindings_req_t *req = bindings_req_alloc(b);
+
+  req->op = OP_WRITE;
+  req->path = (char *) buffer->path.c_str();
+  req->data = (void *) buffer->data;
+  req->offset = buffer->offset;
+  req->length = buffer->length;
+  req->info = &(buffer->info);
+  req->context_pid = buffer->context_pid;
+  req->context_uid = buffer->context_uid;
+  req->context_gid = buffer->context_gid;
+
+  int result = bindings_call(req);
+  bindings_invalidate(b, buffer->path.c_str(), 0);
+
+  // the application was told all of it got written, so a short write loses data
+  if (result >= 0 && (size_t) result < buffer->length) result = -EIO;
+
+  mutex_lock(&(wb->lock));
+  bindings_write_behind_clean(wb, buffer);
+  buffer->length = 0;
+  buffer->end.store(0, std::memory_order_relaxed);
+  buffer->since = 0;
+  mutex_unlock(&(wb->lock));
+
+  return result < 0 ? result : 0;
+}
+
+static bool bindings_write_buffer_due (bindings_write_buffer_t *buffer, const char *path, int flags, uint64_t cutoff) {
+  if (!buffer->since) return false;
+  if (path == NULL) return buffer->since <= cutoff;
+
+  const std::string &key = buffer->path;
+  size_t len = strlen(path);
+  if (key == path) return true;
+  if (!(flags & BINDINGS_INVALIDATE_CHILDREN)) return false;
+  return !strcmp(path, "/") || (key.length() > len && key[len] == '/' && !key.compare(0, len, path));
+}
+
+// flushes the buffers of path (and the paths below it with BINDINGS_INVALIDATE_CHILDREN),
+// or with a NULL path every buffer that got its first write at or before cutoff
+static void bindings_write_behind_flush (bindings_t *b, const char *path, int flags, uint64_t cutoff) {
+  bindings_write_behind_t *wb = b->write_behind;
+  if (wb == NULL) return;
+
+  std::vector<bindings_write_buffer_t *> due;
+
+  // the ones collected are referenced so a release can't free them under us. only
+  // their own locks are held while flushing, so other handles are never held up
+  mutex_lock(&(wb->lock));
+  if (wb->dirty.empty()) {
+    mutex_unlock(&(wb->lock));
+    return;
+  }
+  if (path != NULL && !(flags & BINDINGS_INVALIDATE_CHILDREN)) {
+    std::pair<bindings_dirty_buffers_t::iterator, bindings_dirty_buffers_t::iterator> range = wb->dirty.equal_range(path);
+    for (bindings_dirty_buffers_t::iterator it = range.first; it != range.second; it++) due.push_back(it->second);
+  } else {
+    for (bindings_dirty_buffers_t::iterator it = wb->dirty.begin(); it != wb->dirty.end(); it++) {
+      if (bindings_write_buffer_due(it->second, path, flags, cutoff)) due.push_back(it->second);
+    }
+  }
+  for (size_t i = 0; i < due.size(); i++) due[i]->refs++;
+  mutex_unlock(&(wb->lock));
+
+  for (size_t i = 0; i < due.size(); i++) {
+    bindings_write_buffer_t *buffer = due[i];
+    mutex_lock(&(buffer->lock));
+    if (bindings_write_buffer_due(buffer, path, flags, cutoff)) {
+      int result = bindings_write_buffer_flush(b, buffer);
+      if (result < 0) buffer->error = result;
+    }
+    mutex_unlock(&(buffer->lock));
+    bindings_write_buffer_unref(wb, buffer);
+  }
+}
+
+// getattr doesn't flush, appending writers need the size before every write.
+// the size is grown to cover what is still buffered instead
+static int bindings_write_behind_stat (bindings_t *b, const char *path, struct FUSE_STAT *stat, int result) {
+  bindings_write_behind_t *wb = b->write_behind;
+  if (wb == NULL || result < 0) return result;
+
+  mutex_lock(&(wb->lock));
+  if (!wb->dirty.empty()) {
+    std::pair<bindings_dirty_buffers_t::iterator, bindings_dirty_buffers_t::iterator> range = wb->dirty.equal_range(path);
+    for (bindings_dirty_buffers_t::iterator it = range.first; it != range.second; it++) {
+      int64_t end = it->second->end.load(std::memory_order_relaxed);
+      if (end > (int64_t) stat->st_size) stat->st_size = end;
+    }
+  }
+  mutex_unlock(&(wb->lock));
+
+  return result;
+}
+
+// flush and fsync of the handle, returns the error of an earlier background flush if there was one
+static int bindings_write_buffer_sync (bindings_t *b, bindings_write_buffer_t *buffer) {
+  mutex_lock(&(buffer->lock));
+  int result = bindings_write_buffer_flush(b, buffer);
+  if (buffer->error) result = buffer->error;
+  buffer->error = 0;
+  mutex_unlock(&(buffer->lock));
+  return result;
+}
+
+static int bindings_write_buffer_close (bindings_t *b, bindings_write_buffer_t *buffer) {
+  int result = bindings_write_buffer_sync(b, buffer);
+  bindings_write_buffer_unref(b->write_behind, buffer);
+  return result;
+}
+
+static thread_fn_rtn_t bindings_write_behind_thread (void *data) {
+  bindings_t *b = (bindings_t *) data;
+  bindings_write_behind_t *wb = b->write_behind;
+
+  uv_mutex_lock(&(wb->wake_lock));
+  while (!wb->stopped) {
+    uv_cond_timedwait(&(wb->wake), &(wb->wake_lock), (wb->age / 2 + 1) * 1000000);
+    uv_mutex_unlock(&(wb->wake_lock));
+
+    uint64_t now = bindings_now();
+    bindings_write_behind_flush(b, NULL, 0, now > wb->age ? now - wb->age : 0);
+
+    uv_mutex_lock(&(wb->wake_lock));
+  }
+  uv_mutex_unlock(&(wb->wake_lock));
+
+  // whatever is left goes out before the mount is torn down
+  bindings_write_behind_flush(b, NULL, 0, UINT64_MAX);
+  return 0;
+}
+
+static void bindings_write_behind_stop (bindings_write_behind_t *wb) {
+  uv_mutex_lock(&(wb->wake_lock));
+  wb->stopped = 1;
+  uv_cond_signal(&(wb->wake));
+  uv_mutex_unlock(&(wb->wake_lock));
+  thread_join(wb->thread);
+}
+
+static int bindings_mknod (const char *path, mode_t mode, dev_t dev) {
+  bindings_req_t *req = bindings_get_context();
+  bindings_t *b = req->b;
+
+  req->op = OP_MKNOD;
+  req->path = (char *) path;
+  req->mode = mode;
+  req->dev = dev;
+
+  int result = bindings_call(req);
+  bindings_invalidate(b, path, BINDINGS_INVALIDATE_PARENT);
+  return result;
+}
+
+static int bindings_truncate (const char *path, FUSE_OFF_T size) {
+  bindings_write_behind_flush(bindings_get_mount(), path, 0, 0);
+
+  bindings_req_t *req = bindings_get_context();
+  bindings_t *b = req->b;
+
+  req->op = OP_TRUNCATE;
+  req->path = (char *) path;
+  req->length = size;
+
+  int result = bindings_call(req);
+  bindings_invalidate(b, path, 0);
+  return result;
+}
+
+static int bindings_ftruncate (const char *path, FUSE_OFF_T size, struct fuse_file_info *info) {
+#ifndef _WIN32
+  int fd = bindings_passthrough_fd(info);
+  if (fd > -1) {
+    if (ftruncate(fd, size) < 0) return -errno;
+    bindings_invalidate(bindings_get_mount(), path, 0);
+    return 0;
+  }
+#endif
+
+  // registered for passthrough handles, libfuse would have used truncate otherwise
+  bindings_t *mount = bindings_get_mount();
+  if (mount->ops_ftruncate == NULL) return mount->ops_truncate == NULL ? -ENOSYS : bindings_truncate(path, size);
+  bindings_write_behind_flush(mount, path, 0, 0);
+
+  bindings_req_t *req = bindings_get_context();
+  bindings_t *b = req->b;
+
+  req->op = OP_FTRUNCATE;
+  req->path = (char *) path;
+  req->length = size;
+  req->info = info;
+
+  int result = bindings_call(req);
+  bindings_invalidate(b, path, 0);
+  return result;
+}
+
+static int bindings_getattr (const char *path, struct FUSE_STAT *stat) {
+  bindings_t *b = bindings_get_mount();
+  uint64_t generation = 0;
+
+#ifndef _WIN32
+  if (BINDINGS_PLUGIN_HAS(b, getattr)) {
+    int result = b->plugin->getattr(b->plugin->data, path, stat);
+    if (result != FUSE_BINDINGS_DEFER) return bindings_write_behind_stat(b, path, stat, result);
+  }
+#endif
+
+  if (b->attr_cache != NULL) {
+    int result;
+    if (bindings_attr_cache_get(b->attr_cache, path, stat, &result)) return bindings_write_behind_stat(b, path, stat, result);
+    generation = bindings_attr_cache_generation(b->attr_cache);
+  }
+
+  bindings_req_t *req = bindings_get_context();
+
+  req->op = OP_GETATTR;
+  req->path = (char *) path;
+  req->data = stat;
+  req->cache_generation = generation;
+
+  return bindings_write_behind_stat(b, path, stat, bindings_call(req));
+}
+
+static int bindings_fgetattr (const char *path, struct FUSE_STAT *stat, struct fuse_file_info *info) {
+#ifndef _WIN32
+  int fd = bindings_passthrough_fd(info);
+  if (fd > -1) return fstat(fd, stat) < 0 ? -errno : 0;
+#endif
+
+  bindings_t *b = bindings_get_mount();
+  if (b->ops_fgetattr == NULL) return bindings_getattr(path, stat);
+
+  bindings_req_t *req = bindings_get_context();
+
+  req->op = OP_FGETATTR;
+  req->path = (char *) path;
+  req->data = stat;
+  req->info = info;
+
+  return bindings_write_behind_stat(b, path, stat, bindings_call(req));
+}
+
+static int bindings_flush (const char *path, struct fuse_file_info *info) {
+#ifndef _WIN32
+  int fd = bindings_passthrough_fd(info);
+  if (fd > -1) return close(dup(fd)) < 0 ? -errno : 0;
+#endif
+
+  bindings_t *b = bindings_get_mount();
+  bindings_write_buffer_t *buffer = bindings_file_buffer(info);
+  if (buffer != NULL) {
+    // close reports errors of writes we buffered, so this must not be ENOSYS
+    int result = bindings_write_buffer_sync(b, buffer);
+    if (result < 0 || b->ops_flush == NULL) return result;
+  }
+
+  if (b->ops_flush == NULL) return -ENOSYS;
+
+  bindings_req_t *req = bindings_get_context();
+
+  req->op = OP_FLUSH;
+  req->path = (char *) path;
+  req->info = info;
+
+  return bindings_call(req);
+}
+
+static int bindings_fsync (const char *path, int datasync, struct fuse_file_info *info) {
+#ifndef _WIN32
+  int fd = bindings_passthrough_fd(info);
+#ifdef __APPLE__
+  if (fd > -1) return fsync(fd) < 0 ? -errno : 0;
+#else
+  if (fd > -1) return (datasync ? fdatasync(fd) : fsync(fd)) < 0 ? -errno : 0;
+#endif
+#endif
+
+  bindings_t *b = bindings_get_mount();
+  bindings_write_buffer_t *buffer = bindings_file_buffer(info);
+  if (buffer != NULL) {
+    int result = bindings_write_buffer_sync(b, buffer);
+    if (result < 0 || b->ops_fsync == NULL) return result;
+  }
+
+  if (b->ops_fsync == NULL) return -ENOSYS;
+
+  bindings_req_t *req = bindings_get_context();
+
+  req->op = OP_FSYNC;
+  req->path = (char *) path;
+  req->mode = datasync;
+  req->info = info;
+
+  return bindings_call(req);
+}
+
+static int bindings_fsyncdir (const char *path, int datasync, struct fuse_file_info *info) {
+  bindings_req_t *req = bindings_get_context();
+
+  req->op = OP_FSYNCDIR;
+  req->path = (char *) path;
+  req->mode = datasync;
+  req->info = info;
+
+  return bindings_call(req);
+}
+
+// asks js for the next chunk of the listing, appended to dir->entries
+static int bindings_readdir_chunk (const char *path, struct fuse_file_info *info) {
+  bindings_req_t *req = bindings_get_context();
+  bindings_t *b = req->b;
+
+  req->op = OP_READDIR;
+  req->path = (char *) path;
+  req->info = info;
+  if (b->attr_cache != NULL) req->cache_generation = bindings_attr_cache_generation(b->attr_cache);
+
+  return bindings_call(req);
+}
+
+static int bindings_readdir_paged (const char *path, void *buf, fuse_fill_dir_t filler, FUSE_OFF_T offset, struct fuse_file_info *info) {
+  bindings_dir_t *dir = (bindings_dir_t *) info->fh;
+  int result;
+
+  // rewinddir or a seek backwards, restart the listing
+  if (offset < dir->base) {
+    dir->entries.clear();
+    dir->base = 0;
+    dir->cookie = 0;
+    dir->eof = 0;
+  }
+
+  // entries before offset have been consumed by the kernel
+  while (dir->base < offset) {
+    if (dir->entries.empty()) {
+      if (dir->eof) return 0;
+      if ((result = bindings_readdir_chunk(path, info)) < 0) return result;
+      continue;
+    }
+    dir->entries.pop_front();
+    dir->base++;
+  }
+
+  for (size_t i = 0; true; i++) {
+    while (i >= dir->entries.size()) {
+      if (dir->eof) return 0;
+      if ((result = bindings_readdir_chunk(path, info)) < 0) return result;
+    }
+    if (filler(buf, dir->entries[i].name.c_str(), &(dir->entries[i].stat), dir->base + i + 1)) return 0;
+  }
+}
+
+static int bindings_readdir (const char *path, void *buf, fuse_fill_dir_t filler, FUSE_OFF_T offset, struct fuse_file_info *info) {
+  if (bindings_get_mount()->readdir_paged) return bindings_readdir_paged(path, buf, filler, offset, info);
+
+  bindings_req_t *req = bindings_get_context();
+  bindings_t *b = req->b;
+
+  req->op = OP_READDIR;
+  req->path = (char *) path;
+  req->data = buf;
+  req->filler = filler;
+  if (b->attr_cache != NULL) req->cache_generation = bindings_attr_cache_generation(b->attr_cache);
+
+  return bindings_call(req);
+}
+
+static int bindings_readlink (const char *path, char *buf, size_t len) {
+#ifndef _WIN32
+  bindings_t *b = bindings_get_mount();
+  if (BINDINGS_PLUGIN_HAS(b, readlink)) {
+    int result = b->plugin->readlink(b->plugin->data, path, buf, len);
+    if (result != FUSE_BINDINGS_DEFER) return result;
+  }
+  if (b->ops_readlink == NULL) return -ENOSYS;
+#endif
+
+  bindings_req_t *req = bindings_get_context();
+
+  req->op = OP_READLINK;
+  req->path = (char *) path;
+  req->data = (void *) buf;
+  req->length = len;
+
+  return bindings_call(req);
+}
+
+static int bindings_chown (const char *path, uid_t uid, gid_t gid) {
+  bindings_req_t *req = bindings_get_context();
+  bindings_t *b = req->b;
+
+  req->op = OP_CHOWN;
+  req->path = (char *) path;
+  req->uid = uid;
+  req->gid = gid;
+
+  int result = bindings_call(req);
+  bindings_invalidate(b, path, 0);
+  return result;
+}
+
+static int bindings_chmod (const char *path, mode_t mode) {
+  bindings_req_t *req = bindings_get_context();
+  bindings_t *b = req->b;
+
+  req->op = OP_CHMOD;
+  req->path = (char *) path;
+  req->mode = mode;
+
+  int result = bindings_call(req);
+  bindings_invalidate(b, path, 0);
+  return result;
+}
+
+#ifdef __APPLE__
+static int bindings_setxattr (const char *path, const char *name, const char *value, size_t size, int flags, uint32_t position) {
+  bindings_req_t *req = bindings_get_context();
+
+  req->op = OP_SETXATTR;
+  req->path = (char *) path;
+  req->name = (char *) name;
+  req->data = (void *) value;
+  req->length = size;
+  req->offset = position;
+  req->mode = flags;
+
+  return bindings_call(req);
+}
+
+static int bindings_getxattr (const char *path, const char *name, char *value, size_t size, uint32_t position) {
+  bindings_req_t *req = bindings_get_context();
+
+  req->op = OP_GETXATTR;
+  req->path = (char *) path;
+  req->name = (char *) name;
+  req->data = (void *) value;
+  req->length = size;
+  req->offset = position;
+
+  return bindings_call(req);
+}
+#else
+static int bindings_setxattr (const char *path, const char *name, const char *value, size_t size, int flags) {
+  bindings_req_t *req = bindings_get_context();
+
+  req->op = OP_SETXATTR;
+  req->path = (char *) path;
+  req->name = (char *) name;
+  req->data = (void *) value;
+  req->length = size;
+  req->offset = 0;
+  req->mode = flags;
+
+  return bindings_call(req);
+}
+
+static int bindings_getxattr (const char *path, const char *name, char *value, size_t size) {
+  bindings_req_t *req = bindings_get_context();
+
+  req->op = OP_GETXATTR;
+  req->path = (char *) path;
+  req->name = (char *) name;
+  req->data = (void *) value;
+  req->length = size;
+  req->offset = 0;
+
+  return bindings_call(req);
+}
+#endif
+
+static int bindings_listxattr (const char *path, char *list, size_t size) {
+  bindings_req_t *req = bindings_get_context();
+
+  req->op = OP_LISTXATTR;
+  req->path = (char *) path;
+  req->data = (void *) list;
+  req->length = size;
+
+  return bindings_call(req);
+}
+
+static int bindings_removexattr (const char *path, const char *name) {
+  bindings_req_t *req = bindings_get_context();
+
+  req->op = OP_REMOVEXATTR;
+  req->path = (char *) path;
+  req->name = (char *) name;
+
+  return bindings_call(req);
+}
+
+static int bindings_statfs (const char *path, struct statvfs *statfs) {
+#ifndef _WIN32
+  bindings_t *b = bindings_get_mount();
+  if (BINDINGS_PLUGIN_HAS(b, statfs)) {
+    int result = b->plugin->statfs(b->plugin->data, path, statfs);
+    if (result != FUSE_BINDINGS_DEFER) return result;
+  }
+  if (b->ops_statfs == NULL) return -ENOSYS;
+#endif
+
+  bindings_req_t *req = bindings_get_context();
+  
+  req->op = OP_STATFS;
+  req->path = (char *) path;
+  req->data = statfs;
+
+  return bindings_call(req);
+}
+
+static bindings_file_t *bindings_file_new () {
+  bindings_file_t *file = new bindings_file_t();
+  file->fh = 0;
+  file->backing_fd = -1;
+  file->passthrough_fd = -1;
+  file->buffer = NULL;
+  file->stream = NULL;
+  return file;
+}
+
+NAN_INLINE static void bindings_set_file_fh (bindings_t *b, const char *path, bindings_file_t *file, struct fuse_file_info *info) {
+  if (b->write_behind != NULL && file->backing_fd == -1 && file->passthrough_fd == -1) {
+    file->buffer = bindings_write_buffer_new(b->write_behind->size);
+  }
+  if (b->readahead != NULL && file->passthrough_fd == -1 && !info->direct_io) {
+    file->stream = bindings_stream_new(path, file, info);
+  }
+  info->fh = (uint64_t) file;
+}
+
+static int bindings_open (const char *path, struct fuse_file_info *info) {
+  bindings_t *b = bindings_get_mount();
+  bindings_file_t *file = bindings_file_new();
+  int result = 0;
+  bool deferred = true;
+
+#ifndef _WIN32
+  if (BINDINGS_PLUGIN_HAS(b, open)) {
+    result = b->plugin->open(b->plugin->data, path, info->flags, &(file->fh));
+    deferred = result == FUSE_BINDINGS_DEFER;
+    if (deferred) result = 0;
+  }
+#endif
+
+  if (deferred && b->ops_open != NULL) {
+    bindings_req_t *req = bindings_get_context();
+
+    req->op = OP_OPEN;
+    req->path = (char *) path;
+    req->mode = info->flags;
+    req->info = info;
+    req->data = file;
+
+    result = bindings_call(req);
+  }
+
+  if (result < 0) delete file;
+  else bindings_set_file_fh(b, path, file, info);
+
+  return result;
+}
+
+static int bindings_opendir (const char *path, struct fuse_file_info *info) {
+  bindings_t *b = bindings_get_mount();
+  int result = 0;
+
+  if (b->ops_opendir != NULL) {
+    bindings_req_t *req = bindings_get_context();
+
+    req->op = OP_OPENDIR;
+    req->path = (char *) path;
+    req->mode = info->flags;
+    req->info = info;
+
+    result = bindings_call(req);
+  }
+
+  if (b->readdir_paged && result >= 0) {
+    bindings_dir_t *dir = new bindings_dir_t();
+    dir->fh = info->fh;
+    info->fh = (uint64_t) dir;
+  }
+
+  return result;
+}
+
+static int bindings_read_js (const char *path, char *buf, size_t len, FUSE_OFF_T offset, struct fuse_file_info *info) {
+  bindings_req_t *req = bindings_get_context();
+
+  req->op = OP_READ;
+  req->path = (char *) path;
+  req->data = (void *) buf;
+  req->offset = offset;
+  req->length = len;
+  req->info = info;
+  req->fd = -1;
+
+  bindings_call_wait(req);
+
+  int result = req->result;
+  int fd = req->fd;
+  FUSE_OFF_T fd_offset = req->fd_offset;
+  bindings_req_free(req);
+
+#ifndef _WIN32
+  // no bufvec here so an fd answer has to be copied into the buffer
+  if (fd > -1) {
+    if ((result = pread(fd, buf, result, fd_offset)) < 0) result = -errno;
+    close(fd);
+  }
+#endif
+  return result;
+}
+
+// asks js for the chunks the reader will want next, called without the stream lock
+static void bindings_stream_issue (std::vector<bindings_readahead_chunk_t *> &issue) {
+  for (size_t i = 0; i < issue.size(); i++) {
+    bindings_readahead_chunk_t *chunk = issue[i];
+    bindings_stream_t *stream = chunk->stream;
+    bindings_req_t *req = bindings_get_context();
+
+    req->op = OP_READ;
+    req->path = (char *) stream->path.c_str();
+    req->data = (void *) chunk->data;
+    req->offset = chunk->offset;
+    req->length = chunk->length;
+    req->info = &(stream->info);
+    req->fd = -1;
+
+    bindings_call_async(req, bindings_stream_complete, chunk);
+  }
+}
+
+// grows the window up to next + window, the caller holds the stream lock
+static void bindings_stream_fill (bindings_t *b, bindings_stream_t *stream, uint32_t generation, std::vector<bindings_readahead_chunk_t *> *issue) {
+  // leave most request slots to the foreground
+  int inflight = 0;
+  int max_inflight = std::max(1, b->reqs_length / 4);
+  for (size_t i = 0; i < stream->chunks.size(); i++) {
+    if (!stream->chunks[i]->done) inflight++;
+  }
+
+  if (stream->ahead < stream->next) stream->ahead = stream->next;
+
+  while (stream->ahead < stream->next + (FUSE_OFF_T) stream->window && (stream->eof == -1 || stream->ahead < stream->eof) && inflight < max_inflight) {
+    bindings_readahead_chunk_t *chunk = new bindings_readahead_chunk_t();
+    chunk->stream = stream;
+    chunk->offset = stream->ahead;
+    chunk->length = BINDINGS_READAHEAD_CHUNK;
+    chunk->generation = generation;
+    chunk->data = (char *) malloc(BINDINGS_READAHEAD_CHUNK);
+    chunk->result = 0;
+    chunk->done = 0;
+    chunk->cancelled = 0;
+
+    stream->chunks.push_back(chunk);
+    stream->refs++;
+    stream->ahead += BINDINGS_READAHEAD_CHUNK;
+    issue->push_back(chunk);
+    inflight++;
+  }
+}
+
+// serves what it can from the window and asks js for the rest
+static int bindings_stream_read (bindings_t *b, bindings_stream_t *stream, const char *path, char *buf, size_t len, FUSE_OFF_T offset, struct fuse_file_info *info) {
+  std::vector<bindings_readahead_chunk_t *> issue;
+  uint32_t generation = bindings_readahead_generation(b->readahead, path);
+  size_t done = 0;
+  bool eof = false;
+
+  uv_mutex_lock(&(stream->lock));
+
+  if (offset == stream->next) stream->sequential++;
+  else bindings_stream_reset(stream);
+  stream->next = offset + len;
+
+  while (done < len && !stream->chunks.empty()) {
+    bindings_readahead_chunk_t *chunk = stream->chunks.front();
+    FUSE_OFF_T pos = offset + done;
+
+    if (pos < chunk->offset) break;
+    if (pos >= chunk->offset + (FUSE_OFF_T) chunk->length) {
+      bindings_stream_drop_front(stream); // behind the reader
+      continue;
+    }
+    if (!chunk->done) {
+      uv_cond_wait(&(stream->filled), &(stream->lock));
+      continue;
+    }
+    if (chunk->result < 0 || chunk->generation != generation) {
+      bindings_stream_reset(stream);
+      break;
+    }
+
+    FUSE_OFF_T end = chunk->offset + chunk->result;
+    if (pos >= end) {
+      eof = true;
+      break;
+    }
+
+    size_t copied = std::min((size_t) (end - pos), len - done);
+    memcpy(buf + done, chunk->data + (pos - chunk->offset), copied);
+    done += copied;
+    if (offset + (FUSE_OFF_T) done < end) break;
+
+    // used up, the stream is paying off so the window grows
+    eof = (size_t) chunk->result < chunk->length;
+    bindings_stream_drop_front(stream);
+    stream->window = std::min(stream->window * 2, b->readahead->max);
+    if (eof) break;
+  }
+
+  if (!eof && !stream->disabled && stream->sequential >= BINDINGS_READAHEAD_TRIGGER) {
+    bindings_stream_fill(b, stream, generation, &issue);
+  }
+  uv_mutex_unlock(&(stream->lock));
+
+  bindings_stream_issue(issue);
+  if (done == len || eof) return done;
+
+  int result = bindings_read_js(path, buf + done, len - done, offset + done, info);
+  if (result < 0) return done ? done : result;
+
+  // the file grew past where a chunk saw it end
+  if (result > 0) {
+    uv_mutex_lock(&(stream->lock));
+    if (stream->eof != -1 && offset + (FUSE_OFF_T) (done + result) > stream->eof) stream->eof = -1;
+    uv_mutex_unlock(&(stream->lock));
+  }
+
+  return done + result;
+}
+
+// a js read, through the handle's read-ahead window if it has one
+static int bindings_read_ahead (bindings_t *b, const char *path, char *buf, size_t len, FUSE_OFF_T offset, struct fuse_file_info *info) {
+  bindings_stream_t *stream = bindings_file_stream(info);
+  if (stream == NULL || info->direct_io || stream->path != path) return bindings_read_js(path, buf, len, offset, info);
+  return bindings_stream_read(b, stream, path, buf, len, offset, info);
+}
+
+// a short block is the end of the file, same as a short read
+static int bindings_read_cached (bindings_t *b, const char *path, char *buf, size_t len, FUSE_OFF_T offset, struct fuse_file_info *info) {
+  bindings_block_cache_t *cache = b->block_cache;
+  size_t block_size = cache->block_size;
+  size_t done = 0;
+
+  while (done < len) {
+    uint64_t index = (offset + done) / block_size;
+    size_t within = (offset + done) % block_size;
+    size_t copied;
+    size_t length;
+
+    if (!bindings_block_cache_get(cache, path, index, within, buf + done, len - done, &copied, &length)) {
+      uint64_t generation = bindings_block_cache_generation(cache);
+      char *data = (char *) malloc(block_size);
+      int result = bindings_read_ahead(b, path, data, block_size, index * block_size, info);
+
+      if (result < 0) {
+        free(data);
+        return done ? done : result;
+      }
+
+      length = result;
+      copied = within < length ? std::min(length - within, len - done) : 0;
+      memcpy(buf + done, data + within, copied);
+      if (length < block_size) data = (char *) realloc(data, length ? length : 1);
+      bindings_block_cache_set(cache, path, index, data, length, generation);
+    }
+
+    done += copied;
+    if (length < block_size) break;
+  }
+
+  return done;
+}
+
+#ifndef _WIN32
+NAN_INLINE static int bindings_read_plugin (bindings_t *b, const char *path, char *buf, size_t len, FUSE_OFF_T offset, struct fuse_file_info *info) {
+  return b->plugin->read(b->plugin->data, path, ((bindings_file_t *) info->fh)->fh, buf, len, offset);
+}
+#endif
+
+static int bindings_read (const char *path, char *buf, size_t len, FUSE_OFF_T offset, struct fuse_file_info *info) {
+#ifndef _WIN32
+  int passthrough_fd = bindings_passthrough_fd(info);
+  if (passthrough_fd > -1) {
+    ssize_t read = pread(passthrough_fd, buf, len, offset);
+    return read < 0 ? -errno : read;
+  }
+#endif
+
+  bindings_t *b = bindings_get_mount();
+#ifndef _WIN32
+  if (BINDINGS_PLUGIN_HAS(b, read)) {
+    bindings_write_behind_flush(b, path, 0, 0);
+    int result = bindings_read_plugin(b, path, buf, len, offset, info);
+    if (result != FUSE_BINDINGS_DEFER) return result;
+  }
+#endif
+  if (b->ops_read == NULL) return -ENOSYS;
+  bindings_write_behind_flush(b, path, 0, 0);
+  if (b->block_cache != NULL && !info->direct_io) return bindings_read_cached(b, path, buf, len, offset, info);
+
+  return bindings_read_ahead(b, path, buf, len, offset, info);
+}
+
+#ifdef BINDINGS_HAS_BUFVEC
+static int bindings_read_buf (const char *path, struct fuse_bufvec **bufp, size_t len, FUSE_OFF_T offset, struct fuse_file_info *info) {
+  int passthrough_fd = bindings_passthrough_fd(info);
+  if (passthrough_fd > -1) {
+    struct fuse_bufvec *bufv = (struct fuse_bufvec *) malloc(sizeof(struct fuse_bufvec));
+    *bufv = FUSE_BUFVEC_INIT(len);
+    bufv->buf[0].flags = (enum fuse_buf_flags) (FUSE_BUF_IS_FD | FUSE_BUF_FD_SEEK);
+    bufv->buf[0].fd = passthrough_fd;
+    bufv->buf[0].pos = offset;
+    *bufp = bufv;
+    return 0;
+  }
+
+  bindings_t *b = bindings_get_mount();
+  if (BINDINGS_PLUGIN_HAS(b, read)) {
+    bindings_write_behind_flush(b, path, 0, 0);
+    char *buf = (char *) malloc(len);
+    int result = bindings_read_plugin(b, path, buf, len, offset, info);
+
+    if (result != FUSE_BINDINGS_DEFER) {
+      if (result < 0) {
+        free(buf);
+        return result;
+      }
+
+      struct fuse_bufvec *bufv = (struct fuse_bufvec *) malloc(sizeof(struct fuse_bufvec));
+      *bufv = FUSE_BUFVEC_INIT((size_t) result);
+      bufv->buf[0].mem = buf;
+      *bufp = bufv;
+      return 0;
+    }
+    free(buf);
+  }
+  if (b->ops_read == NULL) return -ENOSYS;
+  bindings_write_behind_flush(b, path, 0, 0);
+
+  if ((b->block_cache != NULL || bindings_file_stream(info) != NULL) && !info->direct_io) {
+    char *buf = (char *) malloc(len);
+    int result = b->block_cache != NULL ? bindings_read_cached(b, path, buf, len, offset, info) : bindings_read_ahead(b, path, buf, len, offset, info);
+    if (result < 0) {
+      free(buf);
+      return result;
+    }
+
+    struct fuse_bufvec *bufv = (struct fuse_bufvec *) malloc(sizeof(struct fuse_bufvec));
+    *bufv = FUSE_BUFVEC_INIT((size_t) result);
+    bufv->buf[0].mem = buf;
+    *bufp = bufv;
+    return 0;
+  }
+
+  bindings_req_t *req = bindings_get_context();
+  char *buf = (char *) malloc(len);
+
+  req->op = OP_READ;
+  req->path = (char *) path;
+  req->data = (void *) buf;
+  req->offset = offset;
+  req->length = len;
+  req->info = info;
+  req->fd = -1;
+
+  bindings_call_wait(req);
+
+  int result = req->result;
+  int fd = req->fd;
+  FUSE_OFF_T fd_offset = req->fd_offset;
+  bindings_req_free(req);
+
+  if (result < 0) {
+    free(buf);
+    return result;
+  }
+
+  // libfuse frees both the bufvec and buf[0].mem after replying
+  struct fuse_bufvec *bufv = (struct fuse_bufvec *) malloc(sizeof(struct fuse_bufvec));
+  *bufv = FUSE_BUFVEC_INIT((size_t) result);
+
+  if (fd > -1) {
+    free(buf);
+    bufv->buf[0].flags = (enum fuse_buf_flags) (FUSE_BUF_IS_FD | FUSE_BUF_FD_SEEK);
+    bufv->buf[0].fd = fd;
+    bufv->buf[0].pos = fd_offset;
+    bindings_spliced_fd.fd = fd;
+  } else {
+    bufv->buf[0].mem = buf;
+  }
+
+  *bufp = bufv;
+  return 0;
+}
+#endif
+
+// the data already went to the backing fd, js gets a write with a null buffer
+static int bindings_write_notify (const char *path, size_t len, FUSE_OFF_T offset, struct fuse_file_info *info) {
+  if (bindings_get_mount()->ops_write == NULL) return len;
+
+  bindings_req_t *req = bindings_get_context();
+  bindings_t *b = req->b;
+
+  req->op = OP_WRITE;
+  req->path = (char *) path;
+  req->data = NULL;
+  req->offset = offset;
+  req->length = len;
+  req->info = info;
+
+  int result = bindings_call(req);
+  bindings_invalidate(b, path, 0);
+  return result < 0 ? result : len;
+}
+
+static int bindings_write_js (const char *path, const char *buf, size_t len, FUSE_OFF_T offset, struct fuse_file_info *info) {
+  bindings_req_t *req = bindings_get_context();
+  bindings_t *b = req->b;
+
+  req->op = OP_WRITE;
+  req->path = (char *) path;
+  req->data = (void *) buf;
+  req->offset = offset;
+  req->length = len;
+  req->info = info;
+
+  int result = bindings_call(req);
+  bindings_invalidate(b, path, 0);
+  return result;
+}
+
+// appends to the handle's buffer, flushing it first if the write doesn't continue where it ends
+static int bindings_write_behind (bindings_t *b, bindings_write_buffer_t *buffer, const char *path, const char *buf, size_t len, FUSE_OFF_T offset, struct fuse_file_info *info) {
+  bindings_write_behind_t *wb = b->write_behind;
+  int result = 0;
+
+  mutex_lock(&(buffer->lock));
+
+  if (buffer->error) {
+    result = buffer->error;
+    buffer->error = 0;
+  } else if (buffer->length && (offset != buffer->offset + (FUSE_OFF_T) buffer->length || buffer->length + len > wb->size || buffer->path != path)) {
+    result = bindings_write_buffer_flush(b, buffer);
+  }
+
+  if (result == 0 && len >= wb->size) {
+    result = bindings_write_js(path, buf, len, offset, info);
+  } else if (result == 0) {
+    if (!buffer->length) {
+      fuse_context *ctx = fuse_get_context();
+      buffer->info = *info;
+      buffer->offset = offset;
+      buffer->context_pid = ctx->pid;
+      buffer->context_uid = ctx->uid;
+      buffer->context_gid = ctx->gid;
+
+      mutex_lock(&(wb->lock));
+      buffer->path = path;
+      buffer->since = std::max<uint64_t>(bindings_now(), 1);
+      wb->dirty.insert(std::make_pair(buffer->path, buffer));
+      mutex_unlock(&(wb->lock));
+    }
+
+    memcpy(buffer->data + buffer->length, buf, len);
+    buffer->length += len;
+    buffer->end.store(buffer->offset + buffer->length, std::memory_order_relaxed);
+    result = len;
+  }
+
+  mutex_unlock(&(buffer->lock));
+  return result;
+}
+
+static int bindings_write (const char *path, const char *buf, size_t len, FUSE_OFF_T offset, struct fuse_file_info * info) {
+  bindings_file_t *file = (bindings_file_t *) info->fh;
+#ifndef _WIN32
+  if (file->passthrough_fd > -1) {
+    ssize_t written = pwrite(file->passthrough_fd, buf, len, offset);
+    if (written < 0) return -errno;
+    bindings_invalidate(bindings_get_mount(), path, 0);
+    return written;
+  }
+  if (file->backing_fd > -1) {
+    ssize_t written = pwrite(file->backing_fd, buf, len, offset);
+    if (written < 0) return -errno;
+    return bindings_write_notify(path, written, offset, info);
+  }
+#endif
+
+  bindings_t *b = bindings_get_mount();
+#ifndef _WIN32
+  if (BINDINGS_PLUGIN_HAS(b, write)) {
+    // the plugin goes before js, so nothing buffered for js may land after it
+    bindings_write_behind_flush(b, path, 0, 0);
+    int result = b->plugin->write(b->plugin->data, path, file->fh, buf, len, offset);
+    if (result != FUSE_BINDINGS_DEFER) {
+      if (result > 0) bindings_invalidate(b, path, 0);
+      return result;
+    }
+  }
+#endif
+  if (b->ops_write == NULL) return -ENOSYS;
+  if (file->buffer != NULL && !info->direct_io) return bindings_write_behind(b, file->buffer, path, buf, len, offset, info);
+
+  return bindings_write_js(path, buf, len, offset, info);
+}
+
+#ifdef BINDINGS_HAS_BUFVEC
+static int bindings_write_buf (const char *path, struct fuse_bufvec *src, FUSE_OFF_T offset, struct fuse_file_info *info) {
+  bindings_file_t *file = (bindings_file_t *) info->fh;
+  size_t len = fuse_buf_size(src);
+  struct fuse_bufvec dst = FUSE_BUFVEC_INIT(len);
+
+  // splices from the fuse pipe when the kernel handed us one
+  if (file->passthrough_fd > -1) {
+    dst.buf[0].flags = (enum fuse_buf_flags) (FUSE_BUF_IS_FD | FUSE_BUF_FD_SEEK);
+    dst.buf[0].fd = file->passthrough_fd;
+    dst.buf[0].pos = offset;
+
+    ssize_t written = fuse_buf_copy(&dst, src, FUSE_BUF_SPLICE_NONBLOCK);
+    if (written > 0) bindings_invalidate(bindings_get_mount(), path, 0);
+    return written;
+  }
+
+  if (file->backing_fd > -1) {
+    dst.buf[0].flags = (enum fuse_buf_flags) (FUSE_BUF_IS_FD | FUSE_BUF_FD_SEEK);
+    dst.buf[0].fd = file->backing_fd;
+    dst.buf[0].pos = offset;
+
+    ssize_t written = fuse_buf_copy(&dst, src, FUSE_BUF_SPLICE_NONBLOCK);
+    if (written < 0) return written;
+    return bindings_write_notify(path, written, offset, info);
+  }
+
+  if (src->count == 1 && src->off == 0 && !(src->buf[0].flags & FUSE_BUF_IS_FD)) {
+    return bindings_write(path, (const char *) src->buf[0].mem, len, offset, info);
+  }
+
+  char *buf = (char *) malloc(len);
+  dst.buf[0].mem = buf;
+
+  ssize_t copied = fuse_buf_copy(&dst, src, (enum fuse_buf_copy_flags) 0);
+  int result = copied < 0 ? copied : bindings_write(path, buf, copied, offset, info);
+
+  free(buf);
+  return result;
+}
+#endif
+
+static int bindings_release (const char *path, struct fuse_file_info *info) {
+  bindings_t *b = bindings_get_mount();
+  bindings_file_t *file = (bindings_file_t *) info->fh;
+  int result = 0;
+
+#ifndef _WIN32
+  // the io of passthrough handles stays native and the fd is ours to close, but
+  // js still hears about the release like it hears about backed writes
+  if (file->passthrough_fd > -1) close(file->passthrough_fd);
+#endif
+
+  if (file->buffer != NULL) result = bindings_write_buffer_close(b, file->buffer);
+  if (file->stream != NULL) bindings_stream_close(file->stream);
+
+  bool deferred = true;
+#ifndef _WIN32
+  if (BINDINGS_PLUGIN_HAS(b, release)) {
+    int released = b->plugin->release(b->plugin->data, path, file->fh);
+    deferred = released == FUSE_BINDINGS_DEFER;
+    if (!deferred && result == 0) result = released;
+  }
+#endif
+
+  if (deferred && b->ops_release != NULL) {
+    bindings_req_t *req = bindings_get_context();
+
+    req->op = OP_RELEASE;
+    req->path = (char *) path;
+    req->info = info;
+
+    int released = bindings_call(req);
+    if (result == 0) result = released;
+  }
+
+  delete file;
+
+  return result;
+}
+
+static int bindings_releasedir (const char *path, struct fuse_file_info *info) {
+  bindings_t *b = bindings_get_mount();
+  int result = 0;
+
+  if (b->ops_releasedir != NULL) {
+    bindings_req_t *req = bindings_get_context();
+
+    req->op = OP_RELEASEDIR;
+    req->path = (char *) path;
+    req->info = info;
+
+    result = bindings_call(req);
+  }
+
+  if (b->readdir_paged) delete (bindings_dir_t *) info->fh;
+
+  return result;
+}
+
+static int bindings_access (const char *path, int mode) {
+  bindings_req_t *req = bindings_get_context();
+
+  req->op = OP_ACCESS;
+  req->path = (char *) path;
+  req->mode = mode;
+
+  return bindings_call(req);
+}
+
+static int bindings_create (const char *path, mode_t mode, struct fuse_file_info *info) {
+  bindings_req_t *req = bindings_get_context();
+  bindings_t *b = req->b;
+  bindings_file_t *file = bindings_file_new();
+
+  req->op = OP_CREATE;
+  req->path = (char *) path;
+  req->mode = mode;
+  req->info = info;
+  req->data = file;
+
+  int result = bindings_call(req);
+  bindings_invalidate(b, path, BINDINGS_INVALIDATE_PARENT);
+
+  if (result < 0) delete file;
+  else bindings_set_file_fh(b, path, file, info);
+
+  return result;
+}
+
+static int bindings_utimens (const char *path, const struct timespec tv[2]) {
+  bindings_req_t *req = bindings_get_context();
+  bindings_t *b = req->b;
+
+  req->op = OP_UTIMENS;
+  req->path = (char *) path;
+  req->data = (void *) tv;
+
+  int result = bindings_call(req);
+  bindings_invalidate(b, path, 0);
+  return result;
+}
+
+static int bindings_unlink (const char *path) {
+  bindings_write_behind_flush(bindings_get_mount(), path, 0, 0);
+
+  bindings_req_t *req = bindings_get_context();
+  bindings_t *b = req->b;
+
+  req->op = OP_UNLINK;
+  req->path = (char *) path;
+
+  int result = bindings_call(req);
+  bindings_invalidate(b, path, BINDINGS_INVALIDATE_PARENT);
+  return result;
+}
+
+static int bindings_rename (const char *src, const char *dest) {
+  // buffers remember the path they were written under
+  bindings_write_behind_flush(bindings_get_mount(), src, BINDINGS_INVALIDATE_CHILDREN, 0);
+  bindings_write_behind_flush(bindings_get_mount(), dest, 0, 0);
+
+  bindings_req_t *req = bindings_get_context();
+  bindings_t *b = req->b;
+
+  req->op = OP_RENAME;
+  req->path = (char *) src;
+  req->data = (void *) dest;
+
+  int result = bindings_call(req);
+  bindings_invalidate(b, src, BINDINGS_INVALIDATE_PARENT | BINDINGS_INVALIDATE_CHILDREN);
+  bindings_invalidate(b, dest, BINDINGS_INVALIDATE_PARENT | BINDINGS_INVALIDATE_CHILDREN);
+  return result;
+}
+
+static int bindings_link (const char *path, const char *dest) {
+  bindings_req_t *req = bindings_get_context();
+  bindings_t *b = req->b;
+
+  req->op = OP_LINK;
+  req->path = (char *) path;
+  req->data = (void *) dest;
+
+  int result = bindings_call(req);
+  bindings_invalidate(b, path, 0);
+  bindings_invalidate(b, dest, BINDINGS_INVALIDATE_PARENT);
+  return result;
+}
+
+static int bindings_symlink (const char *path, const char *dest) {
+  bindings_req_t *req = bindings_get_context();
+  bindings_t *b = req->b;
+
+  req->op = OP_SYMLINK;
+  req->path = (char *) path;
+  req->data = (void *) dest;
+
+  int result = bindings_call(req);
+  bindings_invalidate(b, dest, BINDINGS_INVALIDATE_PARENT);
+  return result;
+}
+
+static int bindings_mkdir (const char *path, mode_t mode) {
+  bindings_req_t *req = bindings_get_context();
+  bindings_t *b = req->b;
+
+  req->op = OP_MKDIR;
+  req->path = (char *) path;
+  req->mode = mode;
+
+  int result = bindings_call(req);
+  bindings_invalidate(b, path, BINDINGS_INVALIDATE_PARENT);
+  return result;
+}
+
+static int bindings_rmdir (const char *path) {
+  bindings_req_t *req = bindings_get_context();
+  bindings_t *b = req->b;
+
+  req->op = OP_RMDIR;
+  req->path = (char *) path;
+
+  int result = bindings_call(req);
+  bindings_invalidate(b, path, BINDINGS_INVALIDATE_PARENT | BINDINGS_INVALIDATE_CHILDREN);
+  return result;
+}
+
+static void* bindings_init (struct fuse_conn_info *conn) {
+  bindings_req_t *req = bindings_get_context();
+
+  bindings_t *b = req->b;
+
+  req->op = OP_INIT;
+  req->data = conn;
+
+  bindings_call(req);
+  return b;
+}
+
+static void bindings_destroy (void *data) {
+  bindings_req_t *req = bindings_get_context();
+
+  req->op = OP_DESTROY;
+
+  bindings_call(req);
+}
+
+#ifndef _WIN32
+// lowlevel (inode based) backend. fuse threads block on the request like in
+// the path based backend and send the reply themselves once js is done
+
+#define BINDINGS_DEFAULT_TIMEOUT 1.0
+
+static bindings_req_t *bindings_ll_context (fuse_req_t fuse_req) {
+  bindings_req_t *req = bindings_req_alloc((bindings_t *) fuse_req_userdata(fuse_req));
+  const struct fuse_ctx *ctx = fuse_req_ctx(fuse_req);
+  req->context_pid = ctx->pid;
+  req->context_uid = ctx->uid;
+  req->context_gid = ctx->gid;
+  req->fuse_req = fuse_req;
+  return req;
+}
+
+NAN_INLINE static void bindings_ll_entry_init (struct fuse_entry_param *e) {
+  memset(e, 0, sizeof(struct fuse_entry_param));
+  e->attr_timeout = BINDINGS_DEFAULT_TIMEOUT;
+  e->entry_timeout = BINDINGS_DEFAULT_TIMEOUT;
+}
+
+static void bindings_ll_reply_err (bindings_req_t *req) {
+  fuse_req_t fuse_req = req->fuse_req;
+  int result = bindings_call(req);
+  fuse_reply_err(fuse_req, result < 0 ? -result : 0);
+}
+
+static void bindings_ll_reply_entry (bindings_req_t *req, struct fuse_entry_param *e) {
+  fuse_req_t fuse_req = req->fuse_req;
+  int result = bindings_call(req);
+  if (result < 0) fuse_reply_err(fuse_req, -result);
+  else fuse_reply_entry(fuse_req, e);
+}
+
+static void bindings_ll_reply_attr (bindings_req_t *req, struct fuse_entry_param *e) {
+  fuse_req_t fuse_req = req->fuse_req;
+  int result = bindings_call(req);
+  if (result < 0) fuse_reply_err(fuse_req, -result);
+  else fuse_reply_attr(fuse_req, &(e->attr), e->attr_timeout);
+}
+
+static void bindings_ll_reply_open (bindings_req_t *req, struct fuse_file_info *info) {
+  fuse_req_t fuse_req = req->fuse_req;
+  int result = bindings_call(req);
+  if (result < 0) fuse_reply_err(fuse_req, -result);
+  else fuse_reply_open(fuse_req, info);
+}
+
+static void bindings_ll_init (void *data, struct fuse_conn_info *conn) {
+  bindings_req_t *req = bindings_req_alloc((bindings_t *) data);
+
+  req->op = OP_INIT;
+  req->data = conn;
+
+  bindings_call(req);
+}
+
+static void bindings_ll_destroy (void *data) {
+  bindings_req_t *req = bindings_req_alloc((bindings_t *) data);
+
+  req->op = OP_DESTROY;
+
+  bindings_call(req);
+}
+
+static void bindings_ll_lookup (fuse_req_t fuse_req, fuse_ino_t parent, const char *name) {
+  bindings_req_t *req = bindings_ll_context(fuse_req);
+  struct fuse_entry_param e;
+  bindings_ll_entry_init(&e);
+
+  req->op = OP_LOOKUP;
+  req->ino = parent;
+  req->name = (char *) name;
+  req->data = &e;
+
+  bindings_ll_reply_entry(req, &e);
+}
+
+static void bindings_ll_forget (fuse_req_t fuse_req, fuse_ino_t ino, unsigned long nlookup) {
+  bindings_req_t *req = bindings_ll_context(fuse_req);
+
+  req->op = OP_FORGET;
+  req->ino = ino;
+  req->length = nlookup;
+
+  bindings_call(req);
+  fuse_reply_none(fuse_req);
+}
+
+static void bindings_ll_getattr (fuse_req_t fuse_req, fuse_ino_t ino, struct fuse_file_info *info) {
+  bindings_req_t *req = bindings_ll_context(fuse_req);
+  struct fuse_entry_param e;
+  bindings_ll_entry_init(&e);
+  e.attr.st_ino = ino;
+
+  req->op = OP_GETATTR;
+  req->ino = ino;
+  req->data = &e;
+
+  bindings_ll_reply_attr(req, &e);
+}
+
+static void bindings_ll_setattr (fuse_req_t fuse_req, fuse_ino_t ino, struct stat *attr, int to_set, struct fuse_file_info *info) {
+  bindings_req_t *req = bindings_ll_context(fuse_req);
+  struct fuse_entry_param e;
+  bindings_ll_entry_init(&e);
+
+  // the attributes to set go to js in e.attr, the resulting ones come back the same way
+  memcpy(&(e.attr), attr, sizeof(struct stat));
+
+  req->op = OP_SETATTR;
+  req->ino = ino;
+  req->mode = to_set;
+  req->info = info;
+  req->data = &e;
+
+  bindings_ll_reply_attr(req, &e);
+}
+
+static void bindings_ll_readlink (fuse_req_t fuse_req, fuse_ino_t ino) {
+  bindings_req_t *req = bindings_ll_context(fuse_req);
+  char link[PATH_MAX + 1];
+  link[0] = '\0';
+
+  req->op = OP_READLINK;
+  req->ino = ino;
+  req->data = link;
+  req->length = sizeof(link);
+
+  int result = bindings_call(req);
+  if (result < 0) fuse_reply_err(fuse_req, -result);
+  else fuse_reply_readlink(fuse_req, link);
+}
+
+static void bindings_ll_mknod (fuse_req_t fuse_req, fuse_ino_t parent, const char *name, mode_t mode, dev_t dev) {
+  bindings_req_t *req = bindings_ll_context(fuse_req);
+  struct fuse_entry_param e;
+  bindings_ll_entry_init(&e);
+
+  req->op = OP_MKNOD;
+  req->ino = parent;
+  req->name = (char *) name;
+  req->mode = mode;
+  req->dev = dev;
+  req->data = &e;
+
+  bindings_ll_reply_entry(req, &e);
+}
+
+static void bindings_ll_mkdir (fuse_req_t fuse_req, fuse_ino_t parent, const char *name, mode_t mode) {
+  bindings_req_t *req = bindings_ll_context(fuse_req);
+  struct fuse_entry_param e;
+  bindings_ll_entry_init(&e);
+
+  req->op = OP_MKDIR;
+  req->ino = parent;
+  req->name = (char *) name;
+  req->mode = mode;
+  req->data = &e;
+
+  bindings_ll_reply_entry(req, &e);
+}
+
+static void bindings_ll_unlink (fuse_req_t fuse_req, fuse_ino_t parent, const char *name) {
+  bindings_req_t *req = bindings_ll_context(fuse_req);
+
+  req->op = OP_UNLINK;
+  req->ino = parent;
+  req->name = (char *) name;
+
+  bindings_ll_reply_err(req);
+}
+
+static void bindings_ll_rmdir (fuse_req_t fuse_req, fuse_ino_t parent, const char *name) {
+  bindings_req_t *req = bindings_ll_context(fuse_req);
+
+  req->op = OP_RMDIR;
+  req->ino = parent;
+  req->name = (char *) name;
+
+  bindings_ll_reply_err(req);
+}
+
+static void bindings_ll_symlink (fuse_req_t fuse_req, const char *link, fuse_ino_t parent, const char *name) {
+  bindings_req_t *req = bindings_ll_context(fuse_req);
+  struct fuse_entry_param e;
+  bindings_ll_entry_init(&e);
+
+  req->op = OP_SYMLINK;
+  req->ino = parent;
+  req->name = (char *) name;
+  req->path = (char *) link;
+  req->data = &e;
+
+  bindings_ll_reply_entry(req, &e);
+}
+
+static void bindings_ll_rename (fuse_req_t fuse_req, fuse_ino_t parent, const char *name, fuse_ino_t newparent, const char *newname) {
+  bindings_req_t *req = bindings_ll_context(fuse_req);
+
+  req->op = OP_RENAME;
+  req->ino = parent;
+  req->name = (char *) name;
+  req->ino2 = newparent;
+  req->path = (char *) newname;
+
+  bindings_ll_reply_err(req);
+}
+
+static void bindings_ll_link (fuse_req_t fuse_req, fuse_ino_t ino, fuse_ino_t newparent, const char *newname) {
+  bindings_req_t *req = bindings_ll_context(fuse_req);
+  struct fuse_entry_param e;
+  bindings_ll_entry_init(&e);
+
+  req->op = OP_LINK;
+  req->ino = ino;
+  req->ino2 = newparent;
+  req->name = (char *) newname;
+  req->data = &e;
+
+  bindings_ll_reply_entry(req, &e);
+}
+
+static void bindings_ll_open (fuse_req_t fuse_req, fuse_ino_t ino, struct fuse_file_info *info) {
+  bindings_req_t *req = bindings_ll_context(fuse_req);
+
+  req->op = OP_OPEN;
+  req->ino = ino;
+  req->mode = info->flags;
+  req->info = info;
+
+  bindings_ll_reply_open(req, info);
+}
+
+static void bindings_ll_opendir (fuse_req_t fuse_req, fuse_ino_t ino, struct fuse_file_info *info) {
+  bindings_req_t *req = bindings_ll_context(fuse_req);
+
+  req->op = OP_OPENDIR;
+  req->ino = ino;
+  req->mode = info->flags;
+  req->info = info;
+
+  bindings_ll_reply_open(req, info);
+}
+
+static void bindings_ll_read (fuse_req_t fuse_req, fuse_ino_t ino, size_t len, off_t offset, struct fuse_file_info *info) {
+  bindings_req_t *req = bindings_ll_context(fuse_req);
+  char *buf = (char *) malloc(len);
+
+  req->op = OP_READ;
+  req->ino = ino;
+  req->data = buf;
+  req->offset = offset;
+  req->length = len;
+  req->info = info;
+  req->fd = -1;
+
+  bindings_call_wait(req);
+
+  int result = req->result;
+  int fd = req->fd;
+  FUSE_OFF_T fd_offset = req->fd_offset;
+  bindings_req_free(req);
+
+  if (result < 0) {
+    fuse_reply_err(fuse_req, -result);
+  } else if (fd > -1) {
+#ifdef BINDINGS_HAS_BUFVEC
+    struct fuse_bufvec bufv = FUSE_BUFVEC_INIT((size_t) result);
+    bufv.buf[0].flags = (enum fuse_buf_flags) (FUSE_BUF_IS_FD | FUSE_BUF_FD_SEEK);
+    bufv.buf[0].fd = fd;
+    bufv.buf[0].pos = fd_offset;
+    fuse_reply_data(fuse_req, &bufv, FUSE_BUF_SPLICE_MOVE);
+#else
+    result = pread(fd, buf, result, fd_offset);
+    if (result < 0) fuse_reply_err(fuse_req, errno);
+    else fuse_reply_buf(fuse_req, buf, result);
+#endif
+    close(fd);
+  } else {
+    fuse_reply_buf(fuse_req, buf, result);
+  }
+  free(buf);
+}
+
+static void bindings_ll_write (fuse_req_t fuse_req, fuse_ino_t ino, const char *buf, size_t len, off_t offset, struct fuse_file_info *info) {
+  bindings_req_t *req = bindings_ll_context(fuse_req);
+
+  req->op = OP_WRITE;
+  req->ino = ino;
+  req->data = (void *) buf;
+  req->offset = offset;
+  req->length = len;
+  req->info = info;
+
+  int result = bindings_call(req);
+  if (result < 0) fuse_reply_err(fuse_req, -result);
+  else fuse_reply_write(fuse_req, result);
+}
+
+static void bindings_ll_flush (fuse_req_t fuse_req, fuse_ino_t ino, struct fuse_file_info *info) {
+  bindings_req_t *req = bindings_ll_context(fuse_req);
+
+  req->op = OP_FLUSH;
+  req->ino = ino;
+  req->info = info;
+
+  bindings_ll_reply_err(req);
+}
+
+static void bindings_ll_release (fuse_req_t fuse_req, fuse_ino_t ino, struct fuse_file_info *info) {
+  bindings_req_t *req = bindings_ll_context(fuse_req);
+
+  req->op = OP_RELEASE;
+  req->ino = ino;
+  req->info = info;
+
+  bindings_ll_reply_err(req);
+}
+
+static void bindings_ll_fsync (fuse_req_t fuse_req, fuse_ino_t ino, int datasync, struct fuse_file_info *info) {
+  bindings_req_t *req = bindings_ll_context(fuse_req);
+
+  req->op = OP_FSYNC;
+  req->ino = ino;
+  req->mode = datasync;
+  req->info = info;
+
+  bindings_ll_reply_err(req);
+}
+
+static void bindings_ll_readdir (fuse_req_t fuse_req, fuse_ino_t ino, size_t len, off_t offset, struct fuse_file_info *info) {
+  bindings_req_t *req = bindings_ll_context(fuse_req);
+  char *buf = (char *) malloc(len);
+
+  req->op = OP_READDIR;
+  req->ino = ino;
+  req->data = buf;
+  req->offset = offset;
+  req->length = len;
+  req->info = info;
+
+  // the completion leaves the number of bytes it filled in length
+  bindings_call_wait(req);
+  int result = req->result;
+  size_t filled = req->length;
+  bindings_req_free(req);
+
+  if (result < 0) fuse_reply_err(fuse_req, -result);
+  else fuse_reply_buf(fuse_req, buf, filled);
+  free(buf);
+}
+
+static void bindings_ll_releasedir (fuse_req_t fuse_req, fuse_ino_t ino, struct fuse_file_info *info) {
+  bindings_req_t *req = bindings_ll_context(fuse_req);
+
+  req->op = OP_RELEASEDIR;
+  req->ino = ino;
+  req->info = info;
+
+  bindings_ll_reply_err(req);
+}
+
+static void bindings_ll_fsyncdir (fuse_req_t fuse_req, fuse_ino_t ino, int datasync, struct fuse_file_info *info) {
+  bindings_req_t *req = bindings_ll_context(fuse_req);
+
+  req->op = OP_FSYNCDIR;
+  req->ino = ino;
+  req->mode = datasync;
+  req->info = info;
+
+  bindings_ll_reply_err(req);
+}
+
+static void bindings_ll_statfs (fuse_req_t fuse_req, fuse_ino_t ino) {
+  bindings_req_t *req = bindings_ll_context(fuse_req);
+  struct statvfs statfs;
+  memset(&statfs, 0, sizeof(statfs));
+
+  req->op = OP_STATFS;
+  req->ino = ino;
+  req->data = &statfs;
+
+  int result = bindings_call(req);
+  if (result < 0) fuse_reply_err(fuse_req, -result);
+  else fuse_reply_statfs(fuse_req, &statfs);
+}
+
+static void bindings_ll_access (fuse_req_t fuse_req, fuse_ino_t ino, int mask) {
+  bindings_req_t *req = bindings_ll_context(fuse_req);
+
+  req->op = OP_ACCESS;
+  req->ino = ino;
+  req->mode = mask;
+
+  bindings_ll_reply_err(req);
+}
+
+static void bindings_ll_create (fuse_req_t fuse_req, fuse_ino_t parent, const char *name, mode_t mode, struct fuse_file_info *info) {
+  bindings_req_t *req = bindings_ll_context(fuse_req);
+  struct fuse_entry_param e;
+  bindings_ll_entry_init(&e);
+
+  req->op = OP_CREATE;
+  req->ino = parent;
+  req->name = (char *) name;
+  req->mode = mode;
+  req->info = info;
+  req->data = &e;
+
+  int result = bindings_call(req);
+  if (result < 0) fuse_reply_err(fuse_req, -result);
+  else fuse_reply_create(fuse_req, &e, info);
+}
+
+#ifdef BINDINGS_HAS_BUFVEC
+static void bindings_ll_retrieve_reply (fuse_req_t fuse_req, void *cookie, fuse_ino_t ino, off_t offset, struct fuse_bufvec *bufv) {
+  bindings_retrieve_t *retrieve = (bindings_retrieve_t *) cookie;
+
+  mutex_lock(&mutex);
+  if (bindings_retrieves.erase(retrieve)) {
+    size_t len = fuse_buf_size(bufv);
+    struct fuse_bufvec dst = FUSE_BUFVEC_INIT(len);
+    retrieve->data = (char *) malloc(len ? len : 1);
+    dst.buf[0].mem = retrieve->data;
+
+    ssize_t copied = fuse_buf_copy(&dst, bufv, (enum fuse_buf_copy_flags) 0);
+    retrieve->length = copied < 0 ? 0 : copied;
+    retrieve->result = copied < 0 ? copied : 0;
+    completion_signal(&(retrieve->done));
+  }
+  mutex_unlock(&mutex);
+
+  fuse_reply_none(fuse_req);
+}
+#endif
+
+// the session is going away, pending retrieves won't get an answer anymore
+static void bindings_notify_close (bindings_t *b) {
+  mutex_lock(&mutex);
+  b->ch = NULL;
+  std::unordered_set<bindings_retrieve_t *>::iterator it = bindings_retrieves.begin();
+  while (it != bindings_retrieves.end()) {
+    if ((*it)->b != b) {
+      it++;
+      continue;
+    }
+    (*it)->result = -ENOTCONN;
+    completion_signal(&((*it)->done));
+    it = bindings_retrieves.erase(it);
+  }
+
+  // notifications in progress are still using the channel, the last one wakes us
+  bool waiting = b->notifying > 0;
+  if (waiting) completion_reset(&(b->notified));
+  mutex_unlock(&mutex);
+
+  if (waiting) completion_wait(&(b->notified), 0);
+}
+
+static struct fuse_session *bindings_ll_new (bindings_t *b, struct fuse_args *args) {
+  struct fuse_lowlevel_ops ops = { };
+
+  if (b->ops_init != NULL) ops.init = bindings_ll_init;
+  if (b->ops_destroy != NULL) ops.destroy = bindings_ll_destroy;
+  if (b->ops_lookup != NULL) ops.lookup = bindings_ll_lookup;
+  if (b->ops_forget != NULL) ops.forget = bindings_ll_forget;
+  if (b->ops_getattr != NULL) ops.getattr = bindings_ll_getattr;
+  if (b->ops_setattr != NULL) ops.setattr = bindings_ll_setattr;
+  if (b->ops_readlink != NULL) ops.readlink = bindings_ll_readlink;
+  if (b->ops_mknod != NULL) ops.mknod = bindings_ll_mknod;
+  if (b->ops_mkdir != NULL) ops.mkdir = bindings_ll_mkdir;
+  if (b->ops_unlink != NULL) ops.unlink = bindings_ll_unlink;
+  if (b->ops_rmdir != NULL) ops.rmdir = bindings_ll_rmdir;
+  if (b->ops_symlink != NULL) ops.symlink = bindings_ll_symlink;
+  if (b->ops_rename != NULL) ops.rename = bindings_ll_rename;
+  if (b->ops_link != NULL) ops.link = bindings_ll_link;
+  if (b->ops_open != NULL) ops.open = bindings_ll_open;
+  if (b->ops_read != NULL) ops.read = bindings_ll_read;
+  if (b->ops_write != NULL) ops.write = bindings_ll_write;
+  if (b->ops_flush != NULL) ops.flush = bindings_ll_flush;
+  if (b->ops_release != NULL) ops.release = bindings_ll_release;
+  if (b->ops_fsync != NULL) ops.fsync = bindings_ll_fsync;
+  if (b->ops_opendir != NULL) ops.opendir = bindings_ll_opendir;
+  if (b->ops_readdir != NULL) ops.readdir = bindings_ll_readdir;
+  if (b->ops_releasedir != NULL) ops.releasedir = bindings_ll_releasedir;
+  if (b->ops_fsyncdir != NULL) ops.fsyncdir = bindings_ll_fsyncdir;
+  if (b->ops_statfs != NULL) ops.statfs = bindings_ll_statfs;
+  if (b->ops_access != NULL) ops.access = bindings_ll_access;
+  if (b->ops_create != NULL) ops.create = bindings_ll_create;
+#ifdef BINDINGS_HAS_BUFVEC
+  ops.retrieve_reply = bindings_ll_retrieve_reply;
+#endif
+
+  return fuse_lowlevel_new(args, &ops, sizeof(struct fuse_lowlevel_ops), b);
+}
+#endif
+
+#ifndef _WIN32
+static void bindings_plugin_unload (struct fuse_bindings_plugin *plugin, void *handle) {
+  if (plugin->destroy != NULL) plugin->destroy(plugin->data);
+  free(plugin);
+  dlclose(handle);
+}
+#endif
+
+// everything tied to the isolate, has to happen on the thread b was set up on
+static void bindings_release_js (bindings_t *b) {
   if (b->ops_access != NULL) delete b->ops_access;
   if (b->ops_truncate != NULL) delete b->ops_truncate;
   if (b->ops_ftruncate != NULL) delete b->ops_ftruncate;
@@ -643,7 +3329,51 @@ static void bindings_free (bindings_t *b) {
   if (b->ops_rmdir != NULL) delete b->ops_rmdir;
   if (b->ops_init != NULL) delete b->ops_init;
   if (b->ops_destroy != NULL) delete b->ops_destroy;
-  if (b->callback != NULL) delete b->callback;
+  if (b->ops_lookup != NULL) delete b->ops_lookup;
+  if (b->ops_forget != NULL) delete b->ops_forget;
+  if (b->ops_setattr != NULL) delete b->ops_setattr;
+  if (b->ops_batch != NULL) delete b->ops_batch;
+
+  if (b->intern != NULL) bindings_intern_destroy(b->intern);
+
+  for (int i = 0; i < b->reqs_length; i++) {
+    if (b->reqs[i].callback != NULL) delete b->reqs[i].callback;
+    b->reqs[i].pool.Reset();
+    b->reqs[i].pool_view.Reset();
+  }
+}
+
+static void bindings_free (bindings_t *b) {
+  if (!b->closed) bindings_release_js(b);
+
+  if (b->attr_cache != NULL) bindings_attr_cache_destroy(b->attr_cache);
+  if (b->block_cache != NULL) bindings_block_cache_destroy(b->block_cache);
+  if (b->write_behind != NULL) bindings_write_behind_destroy(b->write_behind);
+  if (b->readahead != NULL) delete b->readahead;
+  if (b->stats != NULL) bindings_stats_destroy(b->stats);
+  if (b->trace != NULL) bindings_trace_destroy(b->trace);
+
+#ifndef _WIN32
+  if (b->plugin != NULL) bindings_plugin_unload(b->plugin, b->plugin_handle);
+#endif
+
+  // called with mutex held. live shards free themselves on their own loops,
+  // the ones whose worker exited left their memory to us
+  for (int i = 0; i < b->shards_length; i++) {
+    bindings_t *shard = b->shards[i];
+    shard->primary = NULL;
+    if (shard->closed) {
+      bindings_free(shard);
+    } else if (!shard->gone.load(std::memory_order_relaxed)) {
+      shard->closing = 1;
+      uv_async_send(&(shard->async));
+    }
+  }
+  delete[] b->shards;
+
+  delete[] b->reqs;
+  bindings_ring_destroy(b->reqs_free);
+  bindings_ring_destroy(b->pending);
 
   bindings_mounted[b->index] = NULL;
   while (bindings_mounted_count > 0 && bindings_mounted[bindings_mounted_count - 1] == NULL) {
@@ -654,8 +3384,16 @@ static void bindings_free (bindings_t *b) {
 }
 
 static void bindings_on_close (uv_handle_t *handle) {
+  bindings_t *b = (bindings_t *) handle->data;
+
+  // fuse threads of the mount a gone shard served may still free its slots
   mutex_lock(&mutex);
-  bindings_free((bindings_t *) handle->data);
+  if (b->primary != NULL) {
+    bindings_release_js(b);
+    b->closed = 1;
+  } else {
+    bindings_free(b);
+  }
   mutex_unlock(&mutex);
 }
 
@@ -666,14 +3404,30 @@ static thread_fn_rtn_t bindings_thread (void *data) {
 
   if (b->ops_access != NULL) ops.access = bindings_access;
   if (b->ops_truncate != NULL) ops.truncate = bindings_truncate;
-  if (b->ops_ftruncate != NULL) ops.ftruncate = bindings_ftruncate;
   if (b->ops_getattr != NULL) ops.getattr = bindings_getattr;
+#ifndef _WIN32
+  // passthrough handles are served natively, these fall back to js or -ENOSYS for the rest
+  ops.ftruncate = bindings_ftruncate;
+  ops.fgetattr = bindings_fgetattr;
+  ops.flush = bindings_flush;
+  ops.fsync = bindings_fsync;
+  ops.read = bindings_read;
+  ops.write = bindings_write;
+#ifdef BINDINGS_HAS_BUFVEC
+  ops.read_buf = bindings_read_buf;
+  ops.write_buf = bindings_write_buf;
+#endif
+#else
+  if (b->ops_ftruncate != NULL) ops.ftruncate = bindings_ftruncate;
   if (b->ops_fgetattr != NULL) ops.fgetattr = bindings_fgetattr;
-  if (b->ops_flush != NULL) ops.flush = bindings_flush;
-  if (b->ops_fsync != NULL) ops.fsync = bindings_fsync;
+  if (b->ops_flush != NULL || b->write_behind != NULL) ops.flush = bindings_flush;
+  if (b->ops_fsync != NULL || b->write_behind != NULL) ops.fsync = bindings_fsync;
+  if (b->ops_read != NULL) ops.read = bindings_read;
+  if (b->ops_write != NULL) ops.write = bindings_write;
+#endif
   if (b->ops_fsyncdir != NULL) ops.fsyncdir = bindings_fsyncdir;
   if (b->ops_readdir != NULL) ops.readdir = bindings_readdir;
-  if (b->ops_readlink != NULL) ops.readlink = bindings_readlink;
+  if (b->ops_readlink != NULL || BINDINGS_PLUGIN_HAS(b, readlink)) ops.readlink = bindings_readlink;
   if (b->ops_chown != NULL) ops.chown = bindings_chown;
   if (b->ops_chmod != NULL) ops.chmod = bindings_chmod;
   if (b->ops_mknod != NULL) ops.mknod = bindings_mknod;
@@ -681,13 +3435,11 @@ static thread_fn_rtn_t bindings_thread (void *data) {
   if (b->ops_getxattr != NULL) ops.getxattr = bindings_getxattr;
   if (b->ops_listxattr != NULL) ops.listxattr = bindings_listxattr;
   if (b->ops_removexattr != NULL) ops.removexattr = bindings_removexattr;
-  if (b->ops_statfs != NULL) ops.statfs = bindings_statfs;
-  if (b->ops_open != NULL) ops.open = bindings_open;
-  if (b->ops_opendir != NULL) ops.opendir = bindings_opendir;
-  if (b->ops_read != NULL) ops.read = bindings_read;
-  if (b->ops_write != NULL) ops.write = bindings_write;
-  if (b->ops_release != NULL) ops.release = bindings_release;
-  if (b->ops_releasedir != NULL) ops.releasedir = bindings_releasedir;
+  if (b->ops_statfs != NULL || BINDINGS_PLUGIN_HAS(b, statfs)) ops.statfs = bindings_statfs;
+  ops.open = bindings_open;
+  if (b->ops_opendir != NULL || b->readdir_paged) ops.opendir = bindings_opendir;
+  ops.release = bindings_release;
+  if (b->ops_releasedir != NULL || b->readdir_paged) ops.releasedir = bindings_releasedir;
   if (b->ops_create != NULL) ops.create = bindings_create;
   if (b->ops_utimens != NULL) ops.utimens = bindings_utimens;
   if (b->ops_unlink != NULL) ops.unlink = bindings_unlink;
@@ -707,157 +3459,675 @@ static thread_fn_rtn_t bindings_thread (void *data) {
 
   struct fuse_args args = FUSE_ARGS_INIT(argc, argv);
 
- // struct fuse_chan *ch = fuse_mount(b->mnt, &args);
-    ch = fuse_mount(b->mnt, &args);
-
+  struct fuse_chan *ch = fuse_mount(b->mnt, &args);
 
   if (ch == NULL) {
-    b->op = OP_ERROR;
-    bindings_call(b);
+    bindings_req_t *req = bindings_req_alloc(b);
+    req->op = OP_ERROR;
+    bindings_call(req);
     uv_close((uv_handle_t*) &(b->async), &bindings_on_close);
     return NULL;
   }
 
+#ifndef _WIN32
+  if (b->lowlevel) {
+    struct fuse_session *se = bindings_ll_new(b, &args);
+
+    if (se == NULL) {
+      fuse_unmount(b->mnt, ch);
+      bindings_req_t *req = bindings_req_alloc(b);
+      req->op = OP_ERROR;
+      bindings_call(req);
+      uv_close((uv_handle_t*) &(b->async), &bindings_on_close);
+      return NULL;
+    }
+
+    fuse_session_add_chan(se, ch);
+
+    mutex_lock(&mutex);
+    b->ch = ch;
+    mutex_unlock(&mutex);
+
+    if (b->multithread) fuse_session_loop_mt(se);
+    else fuse_session_loop(se);
+
+    bindings_notify_close(b);
+
+    fuse_session_remove_chan(ch);
+    fuse_session_destroy(se);
+    fuse_unmount(b->mnt, ch);
+
+    uv_close((uv_handle_t*) &(b->async), &bindings_on_close);
+
+    return 0;
+  }
+#endif
+
   struct fuse *fuse = fuse_new(ch, &args, &ops, sizeof(struct fuse_operations), b);
 
   if (fuse == NULL) {
-    b->op = OP_ERROR;
-    bindings_call(b);
+    bindings_req_t *req = bindings_req_alloc(b);
+    req->op = OP_ERROR;
+    bindings_call(req);
     uv_close((uv_handle_t*) &(b->async), &bindings_on_close);
     return NULL;
   }
 
-  fuse_loop(fuse);
+  if (b->write_behind != NULL) thread_create(&(b->write_behind->thread), bindings_write_behind_thread, b);
+
+  if (b->multithread) fuse_loop_mt(fuse);
+  else fuse_loop(fuse);
 
+  if (b->write_behind != NULL) bindings_write_behind_stop(b->write_behind);
+
+  // destroys ch as well, which takes it out of the session. if the mount was
+  // already detached by bindings_unmount this just closes the fd
   fuse_unmount(b->mnt, ch);
-  fuse_session_remove_chan(ch);
   fuse_destroy(fuse);
 
-  uv_close((uv_handle_t*) &(b->async), &bindings_on_close);
+  uv_close((uv_handle_t*) &(b->async), &bindings_on_close);
+
+  return 0;
+}
+
+NAN_INLINE static Local<Date> bindings_get_date (struct timespec *out) {
+  int ms = (out->tv_nsec / 1000);
+  return Nan::New<Date>(out->tv_sec * 1000 + ms).ToLocalChecked();
+}
+
+NAN_INLINE static void bindings_set_date (struct timespec *out, Local<Date> date) {
+  double ms = date->NumberValue();
+  time_t secs = (time_t)(ms / 1000.0);
+  time_t rem = ms - (1000.0 * secs);
+  time_t ns = rem * 1000000.0;
+  out->tv_sec = secs;
+  out->tv_nsec = ns;
+}
+
+// fixed layout of the typed array stat protocol, documented in the readme
+enum bindings_stat_fields_t {
+  STAT_DEV = 0,
+  STAT_INO,
+  STAT_MODE,
+  STAT_NLINK,
+  STAT_UID,
+  STAT_GID,
+  STAT_RDEV,
+  STAT_SIZE,
+  STAT_BLOCKS,
+  STAT_BLKSIZE,
+  STAT_ATIME,
+  STAT_ATIME_NSEC,
+  STAT_MTIME,
+  STAT_MTIME_NSEC,
+  STAT_CTIME,
+  STAT_CTIME_NSEC,
+  STAT_LENGTH
+};
+
+template <typename T>
+NAN_INLINE static void bindings_set_stat_fields (struct FUSE_STAT *stat, const T *v) {
+  stat->st_dev = v[STAT_DEV];
+  stat->st_ino = v[STAT_INO];
+  stat->st_mode = v[STAT_MODE];
+  stat->st_nlink = v[STAT_NLINK];
+  stat->st_uid = v[STAT_UID];
+  stat->st_gid = v[STAT_GID];
+  stat->st_rdev = v[STAT_RDEV];
+  stat->st_size = v[STAT_SIZE];
+  stat->st_blocks = v[STAT_BLOCKS];
+  stat->st_blksize = v[STAT_BLKSIZE];
+#ifdef __APPLE__
+  stat->st_atimespec.tv_sec = v[STAT_ATIME];
+  stat->st_atimespec.tv_nsec = v[STAT_ATIME_NSEC];
+  stat->st_mtimespec.tv_sec = v[STAT_MTIME];
+  stat->st_mtimespec.tv_nsec = v[STAT_MTIME_NSEC];
+  stat->st_ctimespec.tv_sec = v[STAT_CTIME];
+  stat->st_ctimespec.tv_nsec = v[STAT_CTIME_NSEC];
+#else
+  stat->st_atim.tv_sec = v[STAT_ATIME];
+  stat->st_atim.tv_nsec = v[STAT_ATIME_NSEC];
+  stat->st_mtim.tv_sec = v[STAT_MTIME];
+  stat->st_mtim.tv_nsec = v[STAT_MTIME_NSEC];
+  stat->st_ctim.tv_sec = v[STAT_CTIME];
+  stat->st_ctim.tv_nsec = v[STAT_CTIME_NSEC];
+#endif
+}
+
+// a stat is either a plain object or a Float64Array/BigInt64Array in the fixed layout above
+static void bindings_set_stat (struct FUSE_STAT *stat, Local<Object> obj) {
+  if (obj->IsFloat64Array()) {
+    double v[STAT_LENGTH] = { };
+    obj.As<Float64Array>()->CopyContents(v, sizeof(v));
+    bindings_set_stat_fields(stat, v);
+    return;
+  }
+
+#ifdef BINDINGS_HAS_BIGINT
+  if (obj->IsBigInt64Array()) {
+    int64_t v[STAT_LENGTH] = { };
+    obj.As<BigInt64Array>()->CopyContents(v, sizeof(v));
+    bindings_set_stat_fields(stat, v);
+    return;
+  }
+#endif
+
+  Local<Value> v;
+  if (!(v = obj->Get(LOCAL_KEY(KEY_DEV)))->IsUndefined()) stat->st_dev = v->NumberValue();
+  if (!(v = obj->Get(LOCAL_KEY(KEY_INO)))->IsUndefined()) stat->st_ino = v->NumberValue();
+  if (!(v = obj->Get(LOCAL_KEY(KEY_MODE)))->IsUndefined()) stat->st_mode = v->Uint32Value();
+  if (!(v = obj->Get(LOCAL_KEY(KEY_NLINK)))->IsUndefined()) stat->st_nlink = v->NumberValue();
+  if (!(v = obj->Get(LOCAL_KEY(KEY_UID)))->IsUndefined()) stat->st_uid = v->NumberValue();
+  if (!(v = obj->Get(LOCAL_KEY(KEY_GID)))->IsUndefined()) stat->st_gid = v->NumberValue();
+  if (!(v = obj->Get(LOCAL_KEY(KEY_RDEV)))->IsUndefined()) stat->st_rdev = v->NumberValue();
+  if (!(v = obj->Get(LOCAL_KEY(KEY_SIZE)))->IsUndefined()) stat->st_size = v->NumberValue();
+  if (!(v = obj->Get(LOCAL_KEY(KEY_BLOCKS)))->IsUndefined()) stat->st_blocks = v->NumberValue();
+  if (!(v = obj->Get(LOCAL_KEY(KEY_BLKSIZE)))->IsUndefined()) stat->st_blksize = v->NumberValue();
+#ifdef __APPLE__
+  if (!(v = obj->Get(LOCAL_KEY(KEY_MTIME)))->IsUndefined()) bindings_set_date(&stat->st_mtimespec, v.As<Date>());
+  if (!(v = obj->Get(LOCAL_KEY(KEY_CTIME)))->IsUndefined()) bindings_set_date(&stat->st_ctimespec, v.As<Date>());
+  if (!(v = obj->Get(LOCAL_KEY(KEY_ATIME)))->IsUndefined()) bindings_set_date(&stat->st_atimespec, v.As<Date>());
+#else
+  if (!(v = obj->Get(LOCAL_KEY(KEY_MTIME)))->IsUndefined()) bindings_set_date(&stat->st_mtim, v.As<Date>());
+  if (!(v = obj->Get(LOCAL_KEY(KEY_CTIME)))->IsUndefined()) bindings_set_date(&stat->st_ctim, v.As<Date>());
+  if (!(v = obj->Get(LOCAL_KEY(KEY_ATIME)))->IsUndefined()) bindings_set_date(&stat->st_atim, v.As<Date>());
+#endif
+}
+
+// capabilities the kernel can offer in init, by the names js uses
+struct bindings_cap_t {
+  const char *name;
+  unsigned flag;
+};
+
+static const bindings_cap_t bindings_caps[] = {
+#ifdef FUSE_CAP_ASYNC_READ
+  {"async_read", FUSE_CAP_ASYNC_READ},
+#endif
+#ifdef FUSE_CAP_POSIX_LOCKS
+  {"posix_locks", FUSE_CAP_POSIX_LOCKS},
+#endif
+#ifdef FUSE_CAP_ATOMIC_O_TRUNC
+  {"atomic_o_trunc", FUSE_CAP_ATOMIC_O_TRUNC},
+#endif
+#ifdef FUSE_CAP_EXPORT_SUPPORT
+  {"export_support", FUSE_CAP_EXPORT_SUPPORT},
+#endif
+#ifdef FUSE_CAP_BIG_WRITES
+  {"big_writes", FUSE_CAP_BIG_WRITES},
+#endif
+#ifdef FUSE_CAP_DONT_MASK
+  {"dont_mask", FUSE_CAP_DONT_MASK},
+#endif
+#ifdef FUSE_CAP_SPLICE_WRITE
+  {"splice_write", FUSE_CAP_SPLICE_WRITE},
+#endif
+#ifdef FUSE_CAP_SPLICE_MOVE
+  {"splice_move", FUSE_CAP_SPLICE_MOVE},
+#endif
+#ifdef FUSE_CAP_SPLICE_READ
+  {"splice_read", FUSE_CAP_SPLICE_READ},
+#endif
+#ifdef FUSE_CAP_FLOCK_LOCKS
+  {"flock_locks", FUSE_CAP_FLOCK_LOCKS},
+#endif
+#ifdef FUSE_CAP_IOCTL_DIR
+  {"ioctl_dir", FUSE_CAP_IOCTL_DIR},
+#endif
+  {NULL, 0}
+};
+
+static Local<Array> bindings_get_caps (unsigned flags) {
+  Local<Array> caps = Nan::New<Array>();
+  for (const bindings_cap_t *cap = bindings_caps; cap->name != NULL; cap++) {
+    if (flags & cap->flag) caps->Set(caps->Length(), LOCAL_STRING(cap->name));
+  }
+  return caps;
+}
+
+static Local<Value> bindings_get_conn (struct fuse_conn_info *conn) {
+  if (conn == NULL) return Nan::Null();
+
+  Local<Object> obj = Nan::New<Object>();
+  obj->Set(LOCAL_STRING("protoMajor"), Nan::New<Number>(conn->proto_major));
+  obj->Set(LOCAL_STRING("protoMinor"), Nan::New<Number>(conn->proto_minor));
+  obj->Set(LOCAL_STRING("asyncRead"), Nan::New<Boolean>(conn->async_read != 0));
+  obj->Set(LOCAL_STRING("maxWrite"), Nan::New<Number>(conn->max_write));
+  obj->Set(LOCAL_STRING("maxReadahead"), Nan::New<Number>(conn->max_readahead));
+  obj->Set(LOCAL_STRING("capable"), bindings_get_caps(conn->capable));
+  obj->Set(LOCAL_STRING("want"), bindings_get_caps(conn->want));
+  return obj;
+}
+
+// applied before init returns, so the kernel sees them in the init reply
+static void bindings_set_conn (struct fuse_conn_info *conn, Local<Object> obj) {
+  Local<Value> max_write = obj->Get(LOCAL_STRING("maxWrite"));
+  Local<Value> max_readahead = obj->Get(LOCAL_STRING("maxReadahead"));
+  Local<Value> async_read = obj->Get(LOCAL_STRING("asyncRead"));
+  Local<Value> want = obj->Get(LOCAL_STRING("want"));
+
+  if (max_write->IsNumber()) conn->max_write = max_write->Uint32Value();
+  if (max_readahead->IsNumber()) conn->max_readahead = max_readahead->Uint32Value();
+
+  if (want->IsArray()) {
+    Local<Array> names = want.As<Array>();
+    unsigned flags = 0;
+    unsigned known = 0;
+    for (const bindings_cap_t *cap = bindings_caps; cap->name != NULL; cap++) known |= cap->flag;
+    for (uint32_t i = 0; i < names->Length(); i++) {
+      Nan::Utf8String name(names->Get(i));
+      for (const bindings_cap_t *cap = bindings_caps; cap->name != NULL; cap++) {
+        if (!strcmp(*name, cap->name)) flags |= cap->flag;
+      }
+    }
+    // flags we don't have a name for are left as libfuse set them
+    conn->want = (conn->want & ~known) | (flags & conn->capable);
+  }
+
+  if (async_read->IsBoolean()) {
+    conn->async_read = async_read->BooleanValue() ? 1 : 0;
+#ifdef FUSE_CAP_ASYNC_READ
+    if (conn->async_read) conn->want |= conn->capable & FUSE_CAP_ASYNC_READ;
+    else conn->want &= ~FUSE_CAP_ASYNC_READ;
+#endif
+  }
+}
+
+NAN_INLINE static void bindings_set_statfs (struct statvfs *statfs, Local<Object> obj) { // from http://linux.die.net/man/2/stat
+  Local<Value> v;
+  if (!(v = obj->Get(LOCAL_KEY(KEY_BSIZE)))->IsUndefined()) statfs->f_bsize = v->Uint32Value();
+  if (!(v = obj->Get(LOCAL_KEY(KEY_FRSIZE)))->IsUndefined()) statfs->f_frsize = v->Uint32Value();
+  if (!(v = obj->Get(LOCAL_KEY(KEY_BLOCKS)))->IsUndefined()) statfs->f_blocks = v->Uint32Value();
+  if (!(v = obj->Get(LOCAL_KEY(KEY_BFREE)))->IsUndefined()) statfs->f_bfree = v->Uint32Value();
+  if (!(v = obj->Get(LOCAL_KEY(KEY_BAVAIL)))->IsUndefined()) statfs->f_bavail = v->Uint32Value();
+  if (!(v = obj->Get(LOCAL_KEY(KEY_FILES)))->IsUndefined()) statfs->f_files = v->Uint32Value();
+  if (!(v = obj->Get(LOCAL_KEY(KEY_FFREE)))->IsUndefined()) statfs->f_ffree = v->Uint32Value();
+  if (!(v = obj->Get(LOCAL_KEY(KEY_FAVAIL)))->IsUndefined()) statfs->f_favail = v->Uint32Value();
+  if (!(v = obj->Get(LOCAL_KEY(KEY_FSID)))->IsUndefined()) statfs->f_fsid = v->Uint32Value();
+  if (!(v = obj->Get(LOCAL_KEY(KEY_FLAG)))->IsUndefined()) statfs->f_flag = v->Uint32Value();
+  if (!(v = obj->Get(LOCAL_KEY(KEY_NAMEMAX)))->IsUndefined()) statfs->f_namemax = v->Uint32Value();
+}
+
+// the caches belong to the mount, not to the shard answering for it
+NAN_INLINE static bindings_attr_cache_t *bindings_mount_attr_cache (bindings_t *b) {
+  return b->primary != NULL ? b->primary->attr_cache : b->attr_cache;
+}
+
+// entries are names or {name, stat, ttl} objects ({name, mode, ino} works too). with the attr
+// cache on, entries that have a stat and a ttl are cached so a following ls -l stays native
+static void bindings_get_dirent (bindings_req_t *req, Local<Value> entry, std::string *name, struct FUSE_STAT *stat) {
+  memset(stat, 0, sizeof(struct FUSE_STAT));
+
+  if (!entry->IsObject()) {
+    Nan::Utf8String str(entry);
+    name->assign(*str);
+    return;
+  }
+
+  Local<Object> obj = entry.As<Object>();
+  Nan::Utf8String str(obj->Get(LOCAL_KEY(KEY_NAME)));
+  name->assign(*str);
+
+  Local<Value> st = obj->Get(LOCAL_KEY(KEY_STAT));
+  if (!st->IsObject()) {
+    bindings_set_stat(stat, obj);
+    return;
+  }
+
+  bindings_set_stat(stat, st.As<Object>());
+
+  bindings_attr_cache_t *attr_cache = bindings_mount_attr_cache(req->b);
+  Local<Value> ttl = obj->Get(LOCAL_KEY(KEY_TTL));
+  if (attr_cache == NULL || !ttl->IsNumber() || ttl->NumberValue() <= 0) return;
+
+  std::string path(req->path);
+  if (path != "/") path += "/";
+  path += *name;
+  bindings_attr_cache_set(attr_cache, path.c_str(), stat, 0, ttl->NumberValue(), req->cache_generation);
+}
+
+// open and create answer with an fh or {fh, backingFd}
+NAN_INLINE static void bindings_set_file (bindings_file_t *file, Local<Value> value) {
+  if (value->IsNumber()) {
+    file->fh = value.As<Number>()->Uint32Value();
+    return;
+  }
+
+  if (!value->IsObject()) return;
+
+  Local<Object> obj = value.As<Object>();
+  if (obj->Has(LOCAL_STRING("fh"))) file->fh = obj->Get(LOCAL_STRING("fh"))->Uint32Value();
+#ifndef _WIN32
+  if (obj->Has(LOCAL_STRING("backingFd"))) file->backing_fd = obj->Get(LOCAL_STRING("backingFd"))->Int32Value();
+  if (obj->Has(LOCAL_STRING("passthroughFd"))) file->passthrough_fd = obj->Get(LOCAL_STRING("passthroughFd"))->Int32Value();
+#endif
+}
+
+// open and create can ask for the kernel page cache to be kept or bypassed on the handle
+NAN_INLINE static void bindings_set_open_flags (struct fuse_file_info *info, Local<Value> value) {
+  if (!value->IsObject()) return;
+
+  Local<Object> obj = value.As<Object>();
+  if (obj->Has(LOCAL_STRING("keepCache"))) info->keep_cache = obj->Get(LOCAL_STRING("keepCache"))->BooleanValue() ? 1 : 0;
+  if (obj->Has(LOCAL_STRING("directIo"))) info->direct_io = obj->Get(LOCAL_STRING("directIo"))->BooleanValue() ? 1 : 0;
+}
+
+class SetDirWorker : public Nan::AsyncWorker {
+ public:
+  SetDirWorker(bindings_req_t *req, char **dirs, struct FUSE_STAT *stats, int dirs_length)
+    : Nan::AsyncWorker(NULL), req(req), dirs(dirs), stats(stats), dirs_length(dirs_length) {}
+  ~SetDirWorker() {}
+
+  void Execute () {
+    fuse_fill_dir_t fillerToCall = req->filler;
+    void *data = req->data;
+    for (int i = 0; i < dirs_length; i++) {
+      fillerToCall(data, dirs[i], stats + i, 0);
+    }
+  }
+  void WorkComplete(){
+    completion_signal(&(req->done));
+    for (int i = 0; i < dirs_length; i++) {
+      free(dirs[i]);
+    }
+    free(dirs);
+    free(stats);
+  }
+ private:
+  bindings_req_t *req;
+  char **dirs;
+  struct FUSE_STAT *stats;
+  int dirs_length;
+};
+
+
+// buffer handed to js for req->data. up to copy_threshold bytes are staged in the
+// slot's pooled buffer, larger ones are wrapped in place as an external buffer
+static Local<Object> bindings_req_buffer (bindings_req_t *req, bool copy_in) {
+  bindings_t *b = req->b;
+  size_t length = req->length;
+
+  if (length > b->copy_threshold || slice_constructor == NULL) return bindings_buffer((char *) req->data, length);
+
+  if (req->pool.IsEmpty()) {
+    Local<Object> pool = Nan::NewBuffer(b->copy_threshold).ToLocalChecked();
+    req->pool.Reset(pool);
+    req->pool_data = node::Buffer::Data(pool);
+  }
+
+  if (req->pool_view.IsEmpty() || req->pool_view_length != length) {
+    Local<Value> tmp[] = {Nan::New(req->pool), Nan::New<Number>(length)};
+    req->pool_view.Reset(slice_constructor->Call(2, tmp).As<Object>());
+    req->pool_view_length = length;
+  }
+
+  if (copy_in) memcpy(req->pool_data, req->data, length);
+  req->pooled = 1;
+
+  return Nan::New(req->pool_view);
+}
+
+// copies what js wrote into the pooled buffer back to the fuse buffer
+NAN_INLINE static void bindings_req_buffer_done (bindings_req_t *req) {
+  if (!req->pooled) return;
+  req->pooled = 0;
+
+  if (req->result < 0) return;
+  if (req->op == OP_READ) {
+    if (req->fd == -1) memcpy(req->data, req->pool_data, req->result < req->length ? req->result : req->length);
+  } else if (req->op == OP_GETXATTR || req->op == OP_LISTXATTR) {
+    memcpy(req->data, req->pool_data, req->length);
+  }
+}
+
+#ifndef _WIN32
+NAN_INLINE static void bindings_ll_set_entry (struct fuse_entry_param *e, Local<Object> obj) {
+  if (obj->Has(LOCAL_KEY(KEY_INO))) e->ino = obj->Get(LOCAL_KEY(KEY_INO))->NumberValue();
+  if (obj->Has(LOCAL_STRING("generation"))) e->generation = obj->Get(LOCAL_STRING("generation"))->NumberValue();
+  if (obj->Has(LOCAL_STRING("attrTimeout"))) e->attr_timeout = obj->Get(LOCAL_STRING("attrTimeout"))->NumberValue();
+  if (obj->Has(LOCAL_STRING("entryTimeout"))) e->entry_timeout = obj->Get(LOCAL_STRING("entryTimeout"))->NumberValue();
+  if (obj->Has(LOCAL_STRING("attr"))) bindings_set_stat(&(e->attr), obj->Get(LOCAL_STRING("attr")).As<Object>());
+  e->attr.st_ino = e->ino;
+}
+
+NAN_INLINE static Local<Object> bindings_ll_get_setattr (struct stat *attr, int to_set) {
+  Local<Object> obj = Nan::New<Object>();
+  if (to_set & FUSE_SET_ATTR_MODE) obj->Set(LOCAL_KEY(KEY_MODE), Nan::New<Number>(attr->st_mode));
+  if (to_set & FUSE_SET_ATTR_UID) obj->Set(LOCAL_KEY(KEY_UID), Nan::New<Number>(attr->st_uid));
+  if (to_set & FUSE_SET_ATTR_GID) obj->Set(LOCAL_KEY(KEY_GID), Nan::New<Number>(attr->st_gid));
+  if (to_set & FUSE_SET_ATTR_SIZE) obj->Set(LOCAL_KEY(KEY_SIZE), Nan::New<Number>(attr->st_size));
+#ifdef __APPLE__
+  if (to_set & FUSE_SET_ATTR_ATIME) obj->Set(LOCAL_KEY(KEY_ATIME), bindings_get_date(&attr->st_atimespec));
+  if (to_set & FUSE_SET_ATTR_MTIME) obj->Set(LOCAL_KEY(KEY_MTIME), bindings_get_date(&attr->st_mtimespec));
+#else
+  if (to_set & FUSE_SET_ATTR_ATIME) obj->Set(LOCAL_KEY(KEY_ATIME), bindings_get_date(&attr->st_atim));
+  if (to_set & FUSE_SET_ATTR_MTIME) obj->Set(LOCAL_KEY(KEY_MTIME), bindings_get_date(&attr->st_mtim));
+#endif
+  return obj;
+}
+
+// fills the lowlevel reply structs from the js callback arguments.
+// runs on the loop thread, the fuse thread replies once signalled
+// fh or {fh, keepCache, directIo}
+NAN_INLINE static void bindings_ll_set_fh (struct fuse_file_info *info, Local<Value> value) {
+  if (value->IsNumber()) {
+    info->fh = value->NumberValue();
+    return;
+  }
+
+  if (!value->IsObject()) return;
+  Local<Value> fh = value.As<Object>()->Get(LOCAL_STRING("fh"));
+  if (fh->IsNumber()) info->fh = fh->NumberValue();
+  bindings_set_open_flags(info, value);
+}
+
+static void bindings_ll_complete (bindings_req_t *req, const Nan::FunctionCallbackInfo<v8::Value> &info) {
+  switch (req->op) {
+    case OP_LOOKUP: {
+      struct fuse_entry_param *e = (struct fuse_entry_param *) req->data;
+      if (info.Length() < 3 || !info[2]->IsObject()) return;
+      bindings_ll_set_entry(e, info[2].As<Object>());
+      // a lookup miss with an entryTimeout is cached by the kernel as a negative entry
+      if (req->result == -ENOENT) {
+        if (!info[2].As<Object>()->Has(LOCAL_STRING("entryTimeout"))) return;
+        e->ino = 0;
+        req->result = 0;
+      }
+    }
+    return;
+
+    case OP_MKNOD:
+    case OP_MKDIR:
+    case OP_SYMLINK:
+    case OP_LINK: {
+      if (req->result || info.Length() < 3 || !info[2]->IsObject()) return;
+      bindings_ll_set_entry((struct fuse_entry_param *) req->data, info[2].As<Object>());
+    }
+    return;
+
+    case OP_CREATE: {
+      if (req->result || info.Length() < 3 || !info[2]->IsObject()) return;
+      bindings_ll_set_entry((struct fuse_entry_param *) req->data, info[2].As<Object>());
+      if (info.Length() > 3) bindings_ll_set_fh(req->info, info[3]);
+    }
+    return;
+
+    case OP_GETATTR:
+    case OP_SETATTR: {
+      struct fuse_entry_param *e = (struct fuse_entry_param *) req->data;
+      if (req->result || info.Length() < 3 || !info[2]->IsObject()) return;
+      if (req->op == OP_SETATTR) memset(&(e->attr), 0, sizeof(struct stat));
+      bindings_set_stat(&(e->attr), info[2].As<Object>());
+      e->attr.st_ino = req->ino;
+      if (info.Length() > 3 && info[3]->IsNumber()) e->attr_timeout = info[3]->NumberValue();
+    }
+    return;
+
+    case OP_OPEN:
+    case OP_OPENDIR: {
+      if (req->result || info.Length() < 3) return;
+      bindings_ll_set_fh(req->info, info[2]);
+    }
+    return;
+
+    case OP_READLINK: {
+      if (req->result || info.Length() < 3 || !info[2]->IsString()) return;
+      Nan::Utf8String link(info[2]);
+      strncpy((char *) req->data, *link, req->length - 1);
+      ((char *) req->data)[req->length - 1] = '\0';
+    }
+    return;
+
+    case OP_STATFS: {
+      if (req->result || info.Length() < 3 || !info[2]->IsObject()) return;
+      bindings_set_statfs((struct statvfs *) req->data, info[2].As<Object>());
+    }
+    return;
 
-  return 0;
-}
+    case OP_READDIR: {
+      // entries are a page starting at the kernel offset, which is the index of the
+      // next entry. the ones that don't fit are asked for again from their own offset
+      size_t filled = 0;
+      if (!req->result && info.Length() > 2 && info[2]->IsArray()) {
+        Local<Array> entries = info[2].As<Array>();
+        struct stat st;
+
+        for (uint32_t i = 0; i < entries->Length(); i++) {
+          Local<Value> entry = entries->Get(i);
+          memset(&st, 0, sizeof(st));
+
+          if (entry->IsObject() && !entry->IsString()) {
+            Local<Object> obj = entry.As<Object>();
+            Local<Value> attr = obj->Get(LOCAL_KEY(KEY_STAT));
+            bindings_set_stat(&st, attr->IsObject() ? attr.As<Object>() : obj);
+            entry = obj->Get(LOCAL_KEY(KEY_NAME));
+          }
 
-NAN_INLINE static Local<Date> bindings_get_date (struct timespec *out) {
-  int ms = (out->tv_nsec / 1000);
-  return Nan::New<Date>(out->tv_sec * 1000 + ms).ToLocalChecked();
-}
+          Nan::Utf8String name(entry);
+          size_t size = fuse_add_direntry(req->fuse_req, (char *) req->data + filled, req->length - filled, *name, &st, req->offset + i + 1);
+          if (size > req->length - filled) break;
+          filled += size;
+        }
+      }
+      req->length = filled;
+    }
+    return;
 
-NAN_INLINE static void bindings_set_date (struct timespec *out, Local<Date> date) {
-  double ms = date->NumberValue();
-  time_t secs = (time_t)(ms / 1000.0);
-  time_t rem = ms - (1000.0 * secs);
-  time_t ns = rem * 1000000.0;
-  out->tv_sec = secs;
-  out->tv_nsec = ns;
+    default:
+    return;
+  }
 }
-
-NAN_INLINE static void bindings_set_stat (struct FUSE_STAT *stat, Local<Object> obj) {
-  if (obj->Has(LOCAL_STRING("dev"))) stat->st_dev = obj->Get(LOCAL_STRING("dev"))->NumberValue();
-  if (obj->Has(LOCAL_STRING("ino"))) stat->st_ino = obj->Get(LOCAL_STRING("ino"))->NumberValue();
-  if (obj->Has(LOCAL_STRING("mode"))) stat->st_mode = obj->Get(LOCAL_STRING("mode"))->Uint32Value();
-  if (obj->Has(LOCAL_STRING("nlink"))) stat->st_nlink = obj->Get(LOCAL_STRING("nlink"))->NumberValue();
-  if (obj->Has(LOCAL_STRING("uid"))) stat->st_uid = obj->Get(LOCAL_STRING("uid"))->NumberValue();
-  if (obj->Has(LOCAL_STRING("gid"))) stat->st_gid = obj->Get(LOCAL_STRING("gid"))->NumberValue();
-  if (obj->Has(LOCAL_STRING("rdev"))) stat->st_rdev = obj->Get(LOCAL_STRING("rdev"))->NumberValue();
-  if (obj->Has(LOCAL_STRING("size"))) stat->st_size = obj->Get(LOCAL_STRING("size"))->NumberValue();
-  if (obj->Has(LOCAL_STRING("blocks"))) stat->st_blocks = obj->Get(LOCAL_STRING("blocks"))->NumberValue();
-  if (obj->Has(LOCAL_STRING("blksize"))) stat->st_blksize = obj->Get(LOCAL_STRING("blksize"))->NumberValue();
-#ifdef __APPLE__
-  if (obj->Has(LOCAL_STRING("mtime"))) bindings_set_date(&stat->st_mtimespec, obj->Get(LOCAL_STRING("mtime")).As<Date>());
-  if (obj->Has(LOCAL_STRING("ctime"))) bindings_set_date(&stat->st_ctimespec, obj->Get(LOCAL_STRING("ctime")).As<Date>());
-  if (obj->Has(LOCAL_STRING("atime"))) bindings_set_date(&stat->st_atimespec, obj->Get(LOCAL_STRING("atime")).As<Date>());
-#else
-  if (obj->Has(LOCAL_STRING("mtime"))) bindings_set_date(&stat->st_mtim, obj->Get(LOCAL_STRING("mtime")).As<Date>());
-  if (obj->Has(LOCAL_STRING("ctime"))) bindings_set_date(&stat->st_ctim, obj->Get(LOCAL_STRING("ctime")).As<Date>());
-  if (obj->Has(LOCAL_STRING("atime"))) bindings_set_date(&stat->st_atim, obj->Get(LOCAL_STRING("atime")).As<Date>());
 #endif
-}
 
-NAN_INLINE static void bindings_set_statfs (struct statvfs *statfs, Local<Object> obj) { // from http://linux.die.net/man/2/stat
-  if (obj->Has(LOCAL_STRING("bsize"))) statfs->f_bsize = obj->Get(LOCAL_STRING("bsize"))->Uint32Value();
-  if (obj->Has(LOCAL_STRING("frsize"))) statfs->f_frsize = obj->Get(LOCAL_STRING("frsize"))->Uint32Value();
-  if (obj->Has(LOCAL_STRING("blocks"))) statfs->f_blocks = obj->Get(LOCAL_STRING("blocks"))->Uint32Value();
-  if (obj->Has(LOCAL_STRING("bfree"))) statfs->f_bfree = obj->Get(LOCAL_STRING("bfree"))->Uint32Value();
-  if (obj->Has(LOCAL_STRING("bavail"))) statfs->f_bavail = obj->Get(LOCAL_STRING("bavail"))->Uint32Value();
-  if (obj->Has(LOCAL_STRING("files"))) statfs->f_files = obj->Get(LOCAL_STRING("files"))->Uint32Value();
-  if (obj->Has(LOCAL_STRING("ffree"))) statfs->f_ffree = obj->Get(LOCAL_STRING("ffree"))->Uint32Value();
-  if (obj->Has(LOCAL_STRING("favail"))) statfs->f_favail = obj->Get(LOCAL_STRING("favail"))->Uint32Value();
-  if (obj->Has(LOCAL_STRING("fsid"))) statfs->f_fsid = obj->Get(LOCAL_STRING("fsid"))->Uint32Value();
-  if (obj->Has(LOCAL_STRING("flag"))) statfs->f_flag = obj->Get(LOCAL_STRING("flag"))->Uint32Value();
-  if (obj->Has(LOCAL_STRING("namemax"))) statfs->f_namemax = obj->Get(LOCAL_STRING("namemax"))->Uint32Value();
-}
+NAN_METHOD(OpCallback) {
+  uint32_t id = info[0]->Uint32Value();
+  bindings_t *b = bindings_mounted[id / BINDINGS_MAX_REQUESTS].load(std::memory_order_acquire);
+  if (b == NULL) return;
+
+  // the callback is bound to the slot, so one called twice (or after the op was
+  // given up on) would otherwise complete whatever request holds the slot now
+  bindings_req_t *req = b->reqs + (id % BINDINGS_MAX_REQUESTS);
+  if (!req->inflight) return;
+  req->inflight = 0;
+
+  if (req->time_enter) req->time_callback = uv_hrtime();
+  req->result = (info.Length() > 1 && info[1]->IsNumber()) ? info[1]->Uint32Value() : 0;
+  if (bindings_current == req) bindings_current = NULL;
+
+  // cb(length, {fd, position}) serves the read from a file descriptor. the fuse
+  // thread reads it after js has moved on, so it gets a copy of its own to close
+#ifndef _WIN32
+  if (req->op == OP_READ && req->result > 0 && info.Length() > 2 && info[2]->IsObject()) {
+    Local<Object> source = info[2].As<Object>();
+    req->fd = dup(source->Get(LOCAL_STRING("fd"))->Int32Value());
+    req->fd_offset = source->Get(LOCAL_STRING("position"))->NumberValue();
+    if (req->fd == -1) req->result = -errno;
+  }
+#endif
 
-class SetDirWorker : public Nan::AsyncWorker {
- public:
-  SetDirWorker(bindings_t *b, char **dirs, int dirs_length)
-    : Nan::AsyncWorker(NULL), b(b), dirs(dirs), dirs_length(dirs_length) {}
-  ~SetDirWorker() {}
+  bindings_req_buffer_done(req);
 
-  void Execute () {
-    fuse_fill_dir_t fillerToCall = b->filler;
-    void *data = b->data;
-    for (int i = 0; i < dirs_length; i++) {
-      fillerToCall(data, dirs[i], &empty_stat, 0);
-    }
+  if (req->complete != NULL) {
+    req->complete(req);
+    return;
   }
-  void WorkComplete(){
-    semaphore_signal(&(b->semaphore_readdir));
-    for (int i = 0; i < dirs_length; i++) {
-      free(dirs[i]);
-    }
-    free(dirs);
+
+  if (req->op == OP_INIT && req->data != NULL && info.Length() > 2 && info[2]->IsObject()) {
+    bindings_set_conn((struct fuse_conn_info *) req->data, info[2].As<Object>());
   }
- private:
-  bindings_t *b;
-  char **dirs;
-  int dirs_length;
-};
 
+#ifndef _WIN32
+  if (b->lowlevel) {
+    bindings_ll_complete(req, info);
+    completion_signal(&(req->done));
+    return;
+  }
+#endif
 
-NAN_METHOD(OpCallback) {
-  bindings_t *b = bindings_mounted[info[0]->Uint32Value()];
-  b->result = (info.Length() > 1 && info[1]->IsNumber()) ? info[1]->Uint32Value() : 0;
-  bindings_current = NULL;
-  
-  if (!b->result) {
-    switch (b->op) {
+  if (!req->result) {
+    switch (req->op) {
       case OP_STATFS: {
-        if (info.Length() > 2 && info[2]->IsObject()) bindings_set_statfs((struct statvfs *) b->data, info[2].As<Object>());
+        if (info.Length() > 2 && info[2]->IsObject()) bindings_set_statfs((struct statvfs *) req->data, info[2].As<Object>());
       }
       break;
 
       case OP_GETATTR:
       case OP_FGETATTR: {
-        if (info.Length() > 2 && info[2]->IsObject()) bindings_set_stat((struct FUSE_STAT *) b->data, info[2].As<Object>());
+        if (info.Length() > 2 && info[2]->IsObject()) bindings_set_stat((struct FUSE_STAT *) req->data, info[2].As<Object>());
       }
       break;
 
       case OP_READDIR: {
+        if (b->readdir_paged) {
+          // the fuse thread is blocked on this request so the dir state is ours
+          bindings_dir_t *dir = (bindings_dir_t *) req->info->fh;
+          uint32_t length = 0;
+
+          if (info.Length() > 2 && info[2]->IsArray()) {
+            Local<Array> dirs = info[2].As<Array>();
+            length = dirs->Length();
+            dir->entries.resize(dir->entries.size() + length);
+            for (uint32_t i = 0; i < length; i++) {
+              bindings_dirent_t &entry = dir->entries[dir->entries.size() - length + i];
+              bindings_get_dirent(req, dirs->Get(i), &(entry.name), &(entry.stat));
+            }
+          }
+
+          if (length > 0 && info.Length() > 3 && info[3]->IsNumber()) dir->cookie = info[3]->NumberValue();
+          else dir->eof = 1;
+          break;
+        }
+
         if (info.Length() > 2 && info[2]->IsArray()) {
           Local<Array> dirs = info[2].As<Array>();
           
           char **dirs_alloc = (char**)malloc(sizeof(char*)*dirs->Length());
+          struct FUSE_STAT *stats_alloc = (struct FUSE_STAT *) malloc(sizeof(struct FUSE_STAT) * dirs->Length());
+          std::string name;
           
           for (uint32_t i = 0; i < dirs->Length(); i++) {
-            
-            Nan::Utf8String dir(dirs->Get(i));
-            
-            dirs_alloc[i] = (char *) malloc(1024);
-            strcpy(dirs_alloc[i], *dir);
+            bindings_get_dirent(req, dirs->Get(i), &name, stats_alloc + i);
+            dirs_alloc[i] = strdup(name.c_str());
           }
           
-          Nan::AsyncQueueWorker(new SetDirWorker(b, dirs_alloc, dirs->Length()));
+          Nan::AsyncQueueWorker(new SetDirWorker(req, dirs_alloc, stats_alloc, dirs->Length()));
           return;
         }
       }
       break;
 
       case OP_CREATE:
-      case OP_OPEN:
+      case OP_OPEN: {
+        if (info.Length() > 2) {
+          bindings_set_file((bindings_file_t *) req->data, info[2]);
+          bindings_set_open_flags(req->info, info[2]);
+        }
+      }
+      break;
+
       case OP_OPENDIR: {
         if (info.Length() > 2 && info[2]->IsNumber()) {
-          b->info->fh = info[2].As<Number>()->Uint32Value();
+          req->info->fh = info[2].As<Number>()->Uint32Value();
         }
       }
       break;
@@ -865,7 +4135,7 @@ NAN_METHOD(OpCallback) {
       case OP_READLINK: {
         if (info.Length() > 2 && info[2]->IsString()) {
           Nan::Utf8String path(info[2]);
-          strcpy((char *) b->data, *path);
+          strcpy((char *) req->data, *path);
         }
       }
       break;
@@ -897,288 +4167,598 @@ NAN_METHOD(OpCallback) {
       case OP_MKDIR:
       case OP_RMDIR:
       case OP_DESTROY:
+      case OP_LOOKUP:
+      case OP_FORGET:
+      case OP_SETATTR:
+      case OP_LENGTH:
       break;
     }
   }
 
-  semaphore_signal(&(b->semaphore));
+  bindings_attr_cache_t *attr_cache = bindings_mount_attr_cache(b);
+  if (req->op == OP_GETATTR && attr_cache != NULL && info.Length() > 3 && info[3]->IsNumber()) {
+    int64_t ttl = info[3]->IntegerValue();
+    if (ttl > 0 && (!req->result || req->result == -ENOENT)) {
+      struct FUSE_STAT *stat = req->result ? NULL : (struct FUSE_STAT *) req->data;
+      bindings_attr_cache_set(attr_cache, req->path, stat, req->result, ttl, req->cache_generation);
+    }
+  }
+
+  completion_signal(&(req->done));
 }
 
-NAN_INLINE static void bindings_call_op_ex (bindings_t *b, Nan::Callback *fn, int argc, Local<Value> *argv, bool isreaddir) {
-  if (fn == NULL){
-    if (isreaddir) {
-      semaphore_signal(&(b->semaphore_readdir));
-    } else {
-      semaphore_signal(&(b->semaphore));}  
-    } 
-  else {
+// argv always ends with the callback. batched ops are queued as {op, args, callback, context} instead
+NAN_INLINE static void bindings_call_op (bindings_req_t *req, Nan::Callback *fn, int argc, Local<Value> *argv) {
+  if (fn == NULL) {
+    completion_signal(&(req->done));
+    return;
+  }
+
+  req->inflight = 1;
+
+  // the context is only valid while the handler runs. with several requests in
+  // flight a later fuse.context() would otherwise see whichever came last
+  if (bindings_batch == NULL || !(req->b->batch_ops & (1ULL << req->op))) {
     fn->Call(argc, argv);
+    bindings_current = NULL;
+    return;
   }
+
+  Local<Array> args = Nan::New<Array>(argc - 1);
+  for (int i = 0; i < argc - 1; i++) args->Set(i, argv[i]);
+
+  Local<Object> batched = Nan::New<Object>();
+  batched->Set(LOCAL_KEY(KEY_OP), Nan::New(bindings_op_strings[req->op]));
+  batched->Set(LOCAL_KEY(KEY_ARGS), args);
+  batched->Set(LOCAL_KEY(KEY_CALLBACK), argv[argc - 1]);
+
+  // fuse.context() is gone by the time ops.batch runs, so each request carries its own
+  Local<Object> context = Nan::New<Object>();
+  context->Set(LOCAL_KEY(KEY_UID), Nan::New(req->context_uid));
+  context->Set(LOCAL_KEY(KEY_GID), Nan::New(req->context_gid));
+  context->Set(LOCAL_KEY(KEY_PID), Nan::New(req->context_pid));
+  batched->Set(LOCAL_KEY(KEY_CONTEXT), context);
+
+  Local<Array> batch = *bindings_batch;
+  batch->Set(batch->Length(), batched);
+  bindings_current = NULL;
 }
 
-NAN_INLINE static void bindings_call_op (bindings_t *b, Nan::Callback *fn, int argc, Local<Value> *argv) {
-  bindings_call_op_ex(b, fn, argc, argv, false);
+#ifndef _WIN32
+#define LOCAL_INO(ino) Nan::New<Number>((double) (ino))
+
+static void bindings_dispatch_ll (bindings_req_t *req, Local<Function> callback) {
+  bindings_t *b = req->b;
+
+  switch (req->op) {
+    case OP_LOOKUP: {
+      Local<Value> tmp[] = {LOCAL_INO(req->ino), bindings_intern(b, req->name), callback};
+      bindings_call_op(req, b->ops_lookup, 3, tmp);
+    }
+    return;
+
+    case OP_FORGET: {
+      Local<Value> tmp[] = {LOCAL_INO(req->ino), Nan::New<Number>(req->length), callback};
+      bindings_call_op(req, b->ops_forget, 3, tmp);
+    }
+    return;
+
+    case OP_GETATTR: {
+      Local<Value> tmp[] = {LOCAL_INO(req->ino), callback};
+      bindings_call_op(req, b->ops_getattr, 2, tmp);
+    }
+    return;
+
+    case OP_SETATTR: {
+      struct fuse_entry_param *e = (struct fuse_entry_param *) req->data;
+      Local<Value> fh = req->info == NULL ? (Local<Value>) Nan::Null() : (Local<Value>) Nan::New<Number>(req->info->fh);
+      Local<Value> tmp[] = {LOCAL_INO(req->ino), bindings_ll_get_setattr(&(e->attr), req->mode), fh, callback};
+      bindings_call_op(req, b->ops_setattr, 4, tmp);
+    }
+    return;
+
+    case OP_READLINK: {
+      Local<Value> tmp[] = {LOCAL_INO(req->ino), callback};
+      bindings_call_op(req, b->ops_readlink, 2, tmp);
+    }
+    return;
+
+    case OP_MKNOD: {
+      Local<Value> tmp[] = {LOCAL_INO(req->ino), bindings_intern(b, req->name), Nan::New<Number>(req->mode), Nan::New<Number>(req->dev), callback};
+      bindings_call_op(req, b->ops_mknod, 5, tmp);
+    }
+    return;
+
+    case OP_MKDIR: {
+      Local<Value> tmp[] = {LOCAL_INO(req->ino), bindings_intern(b, req->name), Nan::New<Number>(req->mode), callback};
+      bindings_call_op(req, b->ops_mkdir, 4, tmp);
+    }
+    return;
+
+    case OP_UNLINK: {
+      Local<Value> tmp[] = {LOCAL_INO(req->ino), bindings_intern(b, req->name), callback};
+      bindings_call_op(req, b->ops_unlink, 3, tmp);
+    }
+    return;
+
+    case OP_RMDIR: {
+      Local<Value> tmp[] = {LOCAL_INO(req->ino), bindings_intern(b, req->name), callback};
+      bindings_call_op(req, b->ops_rmdir, 3, tmp);
+    }
+    return;
+
+    case OP_SYMLINK: {
+      Local<Value> tmp[] = {bindings_intern(b, req->path), LOCAL_INO(req->ino), bindings_intern(b, req->name), callback};
+      bindings_call_op(req, b->ops_symlink, 4, tmp);
+    }
+    return;
+
+    case OP_RENAME: {
+      Local<Value> tmp[] = {LOCAL_INO(req->ino), bindings_intern(b, req->name), LOCAL_INO(req->ino2), bindings_intern(b, req->path), callback};
+      bindings_call_op(req, b->ops_rename, 5, tmp);
+    }
+    return;
+
+    case OP_LINK: {
+      Local<Value> tmp[] = {LOCAL_INO(req->ino), LOCAL_INO(req->ino2), bindings_intern(b, req->name), callback};
+      bindings_call_op(req, b->ops_link, 4, tmp);
+    }
+    return;
+
+    case OP_OPEN: {
+      Local<Value> tmp[] = {LOCAL_INO(req->ino), Nan::New<Number>(req->mode), callback};
+      bindings_call_op(req, b->ops_open, 3, tmp);
+    }
+    return;
+
+    case OP_OPENDIR: {
+      Local<Value> tmp[] = {LOCAL_INO(req->ino), Nan::New<Number>(req->mode), callback};
+      bindings_call_op(req, b->ops_opendir, 3, tmp);
+    }
+    return;
+
+    case OP_READ: {
+      Local<Value> tmp[] = {
+        LOCAL_INO(req->ino),
+        Nan::New<Number>(req->info->fh),
+        bindings_req_buffer(req, false),
+        Nan::New<Number>(req->length),
+        Nan::New<Number>(req->offset),
+        callback
+      };
+      bindings_call_op(req, b->ops_read, 6, tmp);
+    }
+    return;
+
+    case OP_WRITE: {
+      Local<Value> tmp[] = {
+        LOCAL_INO(req->ino),
+        Nan::New<Number>(req->info->fh),
+        bindings_req_buffer(req, true),
+        Nan::New<Number>(req->length),
+        Nan::New<Number>(req->offset),
+        callback
+      };
+      bindings_call_op(req, b->ops_write, 6, tmp);
+    }
+    return;
+
+    case OP_FLUSH: {
+      Local<Value> tmp[] = {LOCAL_INO(req->ino), Nan::New<Number>(req->info->fh), callback};
+      bindings_call_op(req, b->ops_flush, 3, tmp);
+    }
+    return;
+
+    case OP_RELEASE: {
+      Local<Value> tmp[] = {LOCAL_INO(req->ino), Nan::New<Number>(req->info->fh), callback};
+      bindings_call_op(req, b->ops_release, 3, tmp);
+    }
+    return;
+
+    case OP_FSYNC: {
+      Local<Value> tmp[] = {LOCAL_INO(req->ino), Nan::New<Number>(req->info->fh), Nan::New<Number>(req->mode), callback};
+      bindings_call_op(req, b->ops_fsync, 4, tmp);
+    }
+    return;
+
+    case OP_READDIR: {
+      Local<Value> tmp[] = {LOCAL_INO(req->ino), Nan::New<Number>(req->info->fh), Nan::New<Number>(req->offset), callback};
+      bindings_call_op(req, b->ops_readdir, 4, tmp);
+    }
+    return;
+
+    case OP_RELEASEDIR: {
+      Local<Value> tmp[] = {LOCAL_INO(req->ino), Nan::New<Number>(req->info->fh), callback};
+      bindings_call_op(req, b->ops_releasedir, 3, tmp);
+    }
+    return;
+
+    case OP_FSYNCDIR: {
+      Local<Value> tmp[] = {LOCAL_INO(req->ino), Nan::New<Number>(req->info->fh), Nan::New<Number>(req->mode), callback};
+      bindings_call_op(req, b->ops_fsyncdir, 4, tmp);
+    }
+    return;
+
+    case OP_STATFS: {
+      Local<Value> tmp[] = {LOCAL_INO(req->ino), callback};
+      bindings_call_op(req, b->ops_statfs, 2, tmp);
+    }
+    return;
+
+    case OP_ACCESS: {
+      Local<Value> tmp[] = {LOCAL_INO(req->ino), Nan::New<Number>(req->mode), callback};
+      bindings_call_op(req, b->ops_access, 3, tmp);
+    }
+    return;
+
+    case OP_CREATE: {
+      Local<Value> tmp[] = {LOCAL_INO(req->ino), bindings_intern(b, req->name), Nan::New<Number>(req->mode), callback};
+      bindings_call_op(req, b->ops_create, 4, tmp);
+    }
+    return;
+
+    case OP_INIT: {
+      Local<Value> tmp[] = {bindings_get_conn((struct fuse_conn_info *) req->data), callback};
+      bindings_call_op(req, b->ops_init, 2, tmp);
+    }
+    return;
+
+    case OP_ERROR: {
+      Local<Value> tmp[] = {callback};
+      bindings_call_op(req, b->ops_error, 1, tmp);
+    }
+    return;
+
+    case OP_DESTROY: {
+      Local<Value> tmp[] = {callback};
+      bindings_call_op(req, b->ops_destroy, 1, tmp);
+    }
+    return;
+
+    default:
+    completion_signal(&(req->done));
+    return;
+  }
 }
+#endif
 
-static void bindings_dispatch (uv_async_t* handle, int status) {
+static void bindings_dispatch_req (bindings_req_t *req) {
   Nan::HandleScope scope;
-  
-  bindings_t *b = bindings_current = (bindings_t *) handle->data;
-  Local<Function> callback = b->callback->GetFunction();
-  b->result = -1;
 
-  switch (b->op) {
+  bindings_t *b = req->b;
+  bindings_current = req;
+
+  if (req->callback == NULL) {
+    Local<Value> tmp[] = {Nan::New<Number>(req->id), Nan::New<FunctionTemplate>(OpCallback)->GetFunction()};
+    req->callback = new Nan::Callback(callback_constructor->Call(2, tmp).As<Function>());
+  }
+
+  Local<Function> callback = req->callback->GetFunction();
+  req->result = -1;
+  req->pooled = 0;
+  if (req->time_enter) {
+    req->time_dispatch = uv_hrtime();
+    req->time_callback = 0;
+  }
+
+#ifndef _WIN32
+  if (b->lowlevel) {
+    bindings_dispatch_ll(req, callback);
+    return;
+  }
+#endif
+
+  switch (req->op) {
     case OP_INIT: {
-      Local<Value> tmp[] = {callback};
-      bindings_call_op(b, b->ops_init, 1, tmp);
+      Local<Value> tmp[] = {bindings_get_conn((struct fuse_conn_info *) req->data), callback};
+      bindings_call_op(req, b->ops_init, 2, tmp);
     }
     return;
 
     case OP_ERROR: {
       Local<Value> tmp[] = {callback};
-      bindings_call_op(b, b->ops_error, 1, tmp);
+      bindings_call_op(req, b->ops_error, 1, tmp);
     }
     return;
 
     case OP_STATFS: {
-      Local<Value> tmp[] = {LOCAL_STRING(b->path), callback};
-      bindings_call_op(b, b->ops_statfs, 2, tmp);
+      Local<Value> tmp[] = {bindings_intern(b, req->path), callback};
+      bindings_call_op(req, b->ops_statfs, 2, tmp);
     }
     return;
 
     case OP_FGETATTR: {
-      Local<Value> tmp[] = {LOCAL_STRING(b->path), Nan::New<Number>(b->info->fh), callback};
-      bindings_call_op(b, b->ops_fgetattr, 3, tmp);
+      Local<Value> tmp[] = {bindings_intern(b, req->path), Nan::New<Number>(bindings_file_fh(req->info)), callback};
+      bindings_call_op(req, b->ops_fgetattr, 3, tmp);
     }
     return;
 
     case OP_GETATTR: {
-      Local<Value> tmp[] = {LOCAL_STRING(b->path), callback};
-      bindings_call_op(b, b->ops_getattr, 2, tmp);
+      Local<Value> tmp[] = {bindings_intern(b, req->path), callback};
+      bindings_call_op(req, b->ops_getattr, 2, tmp);
     }
     return;
 
     case OP_READDIR: {
-      Local<Value> tmp[] = {LOCAL_STRING(b->path), callback};
-      bindings_call_op_ex(b, b->ops_readdir, 2, tmp, true);
+      if (b->readdir_paged) {
+        bindings_dir_t *dir = (bindings_dir_t *) req->info->fh;
+        Local<Value> tmp[] = {bindings_intern(b, req->path), Nan::New<Number>(dir->fh), Nan::New<Number>(dir->cookie), callback};
+        bindings_call_op(req, b->ops_readdir, 4, tmp);
+        return;
+      }
+
+      Local<Value> tmp[] = {bindings_intern(b, req->path), callback};
+      bindings_call_op(req, b->ops_readdir, 2, tmp);
     }
     return;
 
     case OP_CREATE: {
-      Local<Value> tmp[] = {LOCAL_STRING(b->path), Nan::New<Number>(b->mode), callback};
-      bindings_call_op(b, b->ops_create, 3, tmp);
+      Local<Value> tmp[] = {bindings_intern(b, req->path), Nan::New<Number>(req->mode), callback};
+      bindings_call_op(req, b->ops_create, 3, tmp);
     }
     return;
 
     case OP_TRUNCATE: {
-      Local<Value> tmp[] = {LOCAL_STRING(b->path), Nan::New<Number>(b->length), callback};
-      bindings_call_op(b, b->ops_truncate, 3, tmp);
+      Local<Value> tmp[] = {bindings_intern(b, req->path), Nan::New<Number>(req->length), callback};
+      bindings_call_op(req, b->ops_truncate, 3, tmp);
     }
     return;
 
     case OP_FTRUNCATE: {
-      Local<Value> tmp[] = {LOCAL_STRING(b->path), Nan::New<Number>(b->info->fh), Nan::New<Number>(b->length), callback};
-      bindings_call_op(b, b->ops_ftruncate, 4, tmp);
+      Local<Value> tmp[] = {bindings_intern(b, req->path), Nan::New<Number>(bindings_file_fh(req->info)), Nan::New<Number>(req->length), callback};
+      bindings_call_op(req, b->ops_ftruncate, 4, tmp);
     }
     return;
 
     case OP_ACCESS: {
-      Local<Value> tmp[] = {LOCAL_STRING(b->path), Nan::New<Number>(b->mode), callback};
-      bindings_call_op(b, b->ops_access, 3, tmp);
+      Local<Value> tmp[] = {bindings_intern(b, req->path), Nan::New<Number>(req->mode), callback};
+      bindings_call_op(req, b->ops_access, 3, tmp);
     }
     return;
 
     case OP_OPEN: {
-      Local<Value> tmp[] = {LOCAL_STRING(b->path), Nan::New<Number>(b->mode), callback};
-      bindings_call_op(b, b->ops_open, 3, tmp);
+      Local<Value> tmp[] = {bindings_intern(b, req->path), Nan::New<Number>(req->mode), callback};
+      bindings_call_op(req, b->ops_open, 3, tmp);
     }
     return;
 
     case OP_OPENDIR: {
-      Local<Value> tmp[] = {LOCAL_STRING(b->path), Nan::New<Number>(b->mode), callback};
-      bindings_call_op(b, b->ops_opendir, 3, tmp);
+      Local<Value> tmp[] = {bindings_intern(b, req->path), Nan::New<Number>(req->mode), callback};
+      bindings_call_op(req, b->ops_opendir, 3, tmp);
     }
     return;
 
     case OP_WRITE: {
       Local<Value> tmp[] = {
-        LOCAL_STRING(b->path),
-        Nan::New<Number>(b->info->fh),
-        bindings_buffer((char *) b->data, b->length),
-        Nan::New<Number>(b->length), // TODO: remove me
-        Nan::New<Number>(b->offset),
+        bindings_intern(b, req->path),
+        Nan::New<Number>(bindings_file_fh(req->info)),
+        req->data == NULL ? (Local<Value>) Nan::Null() : (Local<Value>) bindings_req_buffer(req, true),
+        Nan::New<Number>(req->length), // TODO: remove me
+        Nan::New<Number>(req->offset),
         callback
       };
-      bindings_call_op(b, b->ops_write, 6, tmp);
+      bindings_call_op(req, b->ops_write, 6, tmp);
     }
     return;
 
     case OP_READ: {
       Local<Value> tmp[] = {
-        LOCAL_STRING(b->path),
-        Nan::New<Number>(b->info->fh),
-        bindings_buffer((char *) b->data, b->length),
-        Nan::New<Number>(b->length), // TODO: remove me
-        Nan::New<Number>(b->offset),
+        bindings_intern(b, req->path),
+        Nan::New<Number>(bindings_file_fh(req->info)),
+        bindings_req_buffer(req, false),
+        Nan::New<Number>(req->length), // TODO: remove me
+        Nan::New<Number>(req->offset),
         callback
       };
-      bindings_call_op(b, b->ops_read, 6, tmp);
+      bindings_call_op(req, b->ops_read, 6, tmp);
     }
     return;
 
     case OP_RELEASE: {
-      Local<Value> tmp[] = {LOCAL_STRING(b->path), Nan::New<Number>(b->info->fh), callback};
-      bindings_call_op(b, b->ops_release, 3, tmp);
+      Local<Value> tmp[] = {bindings_intern(b, req->path), Nan::New<Number>(bindings_file_fh(req->info)), callback};
+      bindings_call_op(req, b->ops_release, 3, tmp);
     }
     return;
 
     case OP_RELEASEDIR: {
-      Local<Value> tmp[] = {LOCAL_STRING(b->path), Nan::New<Number>(b->info->fh), callback};
-      bindings_call_op(b, b->ops_releasedir, 3, tmp);
+      Local<Value> tmp[] = {bindings_intern(b, req->path), Nan::New<Number>(bindings_dir_fh(b, req->info)), callback};
+      bindings_call_op(req, b->ops_releasedir, 3, tmp);
     }
     return;
 
     case OP_UNLINK: {
-      Local<Value> tmp[] = {LOCAL_STRING(b->path), callback};
-      bindings_call_op(b, b->ops_unlink, 2, tmp);
+      Local<Value> tmp[] = {bindings_intern(b, req->path), callback};
+      bindings_call_op(req, b->ops_unlink, 2, tmp);
     }
     return;
 
     case OP_RENAME: {
-      Local<Value> tmp[] = {LOCAL_STRING(b->path), LOCAL_STRING((char *) b->data), callback};
-      bindings_call_op(b, b->ops_rename, 3, tmp);
+      Local<Value> tmp[] = {bindings_intern(b, req->path), bindings_intern(b, (char *) req->data), callback};
+      bindings_call_op(req, b->ops_rename, 3, tmp);
     }
     return;
 
     case OP_LINK: {
-      Local<Value> tmp[] = {LOCAL_STRING(b->path), LOCAL_STRING((char *) b->data), callback};
-      bindings_call_op(b, b->ops_link, 3, tmp);
+      Local<Value> tmp[] = {bindings_intern(b, req->path), bindings_intern(b, (char *) req->data), callback};
+      bindings_call_op(req, b->ops_link, 3, tmp);
     }
     return;
 
     case OP_SYMLINK: {
-      Local<Value> tmp[] = {LOCAL_STRING(b->path), LOCAL_STRING((char *) b->data), callback};
-      bindings_call_op(b, b->ops_symlink, 3, tmp);
+      Local<Value> tmp[] = {bindings_intern(b, req->path), bindings_intern(b, (char *) req->data), callback};
+      bindings_call_op(req, b->ops_symlink, 3, tmp);
     }
     return;
 
     case OP_CHMOD: {
-      Local<Value> tmp[] = {LOCAL_STRING(b->path), Nan::New<Number>(b->mode), callback};
-      bindings_call_op(b, b->ops_chmod, 3, tmp);
+      Local<Value> tmp[] = {bindings_intern(b, req->path), Nan::New<Number>(req->mode), callback};
+      bindings_call_op(req, b->ops_chmod, 3, tmp);
     }
     return;
 
     case OP_MKNOD: {
-      Local<Value> tmp[] = {LOCAL_STRING(b->path), Nan::New<Number>(b->mode), Nan::New<Number>(b->dev), callback};
-      bindings_call_op(b, b->ops_mknod, 4, tmp);
+      Local<Value> tmp[] = {bindings_intern(b, req->path), Nan::New<Number>(req->mode), Nan::New<Number>(req->dev), callback};
+      bindings_call_op(req, b->ops_mknod, 4, tmp);
     }
     return;
 
     case OP_CHOWN: {
-      Local<Value> tmp[] = {LOCAL_STRING(b->path), Nan::New<Number>(b->uid), Nan::New<Number>(b->gid), callback};
-      bindings_call_op(b, b->ops_chown, 4, tmp);
+      Local<Value> tmp[] = {bindings_intern(b, req->path), Nan::New<Number>(req->uid), Nan::New<Number>(req->gid), callback};
+      bindings_call_op(req, b->ops_chown, 4, tmp);
     }
     return;
 
     case OP_READLINK: {
-      Local<Value> tmp[] = {LOCAL_STRING(b->path), callback};
-      bindings_call_op(b, b->ops_readlink, 2, tmp);
+      Local<Value> tmp[] = {bindings_intern(b, req->path), callback};
+      bindings_call_op(req, b->ops_readlink, 2, tmp);
     }
     return;
 
     case OP_SETXATTR: {
       Local<Value> tmp[] = {
-        LOCAL_STRING(b->path),
-        LOCAL_STRING(b->name),
-        bindings_buffer((char *) b->data, b->length),
-        Nan::New<Number>(b->length),
-        Nan::New<Number>(b->offset),
-        Nan::New<Number>(b->mode),
+        bindings_intern(b, req->path),
+        bindings_intern(b, req->name),
+        bindings_req_buffer(req, true),
+        Nan::New<Number>(req->length),
+        Nan::New<Number>(req->offset),
+        Nan::New<Number>(req->mode),
         callback
       };
-      bindings_call_op(b, b->ops_setxattr, 7, tmp);
+      bindings_call_op(req, b->ops_setxattr, 7, tmp);
     }
     return;
 
     case OP_GETXATTR: {
       Local<Value> tmp[] = {
-        LOCAL_STRING(b->path),
-        LOCAL_STRING(b->name),
-        bindings_buffer((char *) b->data, b->length),
-        Nan::New<Number>(b->length),
-        Nan::New<Number>(b->offset),
+        bindings_intern(b, req->path),
+        bindings_intern(b, req->name),
+        bindings_req_buffer(req, false),
+        Nan::New<Number>(req->length),
+        Nan::New<Number>(req->offset),
         callback
       };
-      bindings_call_op(b, b->ops_getxattr, 6, tmp);
+      bindings_call_op(req, b->ops_getxattr, 6, tmp);
     }
     return;
 
     case OP_LISTXATTR: {
       Local<Value> tmp[] = {
-        LOCAL_STRING(b->path),
-        bindings_buffer((char *) b->data, b->length),
-        Nan::New<Number>(b->length),
+        bindings_intern(b, req->path),
+        bindings_req_buffer(req, false),
+        Nan::New<Number>(req->length),
         callback
       };
-      bindings_call_op(b, b->ops_listxattr, 4, tmp);
+      bindings_call_op(req, b->ops_listxattr, 4, tmp);
     }
     return;
 
     case OP_REMOVEXATTR: {
       Local<Value> tmp[] = {
-        LOCAL_STRING(b->path),
-        LOCAL_STRING(b->name),
+        bindings_intern(b, req->path),
+        bindings_intern(b, req->name),
         callback
       };
-      bindings_call_op(b, b->ops_removexattr, 3, tmp);
+      bindings_call_op(req, b->ops_removexattr, 3, tmp);
     }
     return;
 
     case OP_MKDIR: {
-      Local<Value> tmp[] = {LOCAL_STRING(b->path), Nan::New<Number>(b->mode), callback};
-      bindings_call_op(b, b->ops_mkdir, 3, tmp);
+      Local<Value> tmp[] = {bindings_intern(b, req->path), Nan::New<Number>(req->mode), callback};
+      bindings_call_op(req, b->ops_mkdir, 3, tmp);
     }
     return;
 
     case OP_RMDIR: {
-      Local<Value> tmp[] = {LOCAL_STRING(b->path), callback};
-      bindings_call_op(b, b->ops_rmdir, 2, tmp);
+      Local<Value> tmp[] = {bindings_intern(b, req->path), callback};
+      bindings_call_op(req, b->ops_rmdir, 2, tmp);
     }
     return;
 
     case OP_DESTROY: {
       Local<Value> tmp[] = {callback};
-      bindings_call_op(b, b->ops_destroy, 1, tmp);
+      bindings_call_op(req, b->ops_destroy, 1, tmp);
     }
     return;
 
     case OP_UTIMENS: {
-      struct timespec *tv = (struct timespec *) b->data;
-      Local<Value> tmp[] = {LOCAL_STRING(b->path), bindings_get_date(tv), bindings_get_date(tv + 1), callback};
-      bindings_call_op(b, b->ops_utimens, 4, tmp);
+      struct timespec *tv = (struct timespec *) req->data;
+      Local<Value> tmp[] = {bindings_intern(b, req->path), bindings_get_date(tv), bindings_get_date(tv + 1), callback};
+      bindings_call_op(req, b->ops_utimens, 4, tmp);
     }
     return;
 
     case OP_FLUSH: {
-      Local<Value> tmp[] = {LOCAL_STRING(b->path), Nan::New<Number>(b->info->fh), callback};
-      bindings_call_op(b, b->ops_flush, 3, tmp);
+      Local<Value> tmp[] = {bindings_intern(b, req->path), Nan::New<Number>(bindings_file_fh(req->info)), callback};
+      bindings_call_op(req, b->ops_flush, 3, tmp);
     }
     return;
 
     case OP_FSYNC: {
-      Local<Value> tmp[] = {LOCAL_STRING(b->path), Nan::New<Number>(b->info->fh), Nan::New<Number>(b->mode), callback};
-      bindings_call_op(b, b->ops_fsync, 4, tmp);
+      Local<Value> tmp[] = {bindings_intern(b, req->path), Nan::New<Number>(bindings_file_fh(req->info)), Nan::New<Number>(req->mode), callback};
+      bindings_call_op(req, b->ops_fsync, 4, tmp);
     }
     return;
 
     case OP_FSYNCDIR: {
-      Local<Value> tmp[] = {LOCAL_STRING(b->path), Nan::New<Number>(b->info->fh), Nan::New<Number>(b->mode), callback};
-      bindings_call_op(b, b->ops_fsyncdir, 4, tmp);
+      Local<Value> tmp[] = {bindings_intern(b, req->path), Nan::New<Number>(bindings_dir_fh(b, req->info)), Nan::New<Number>(req->mode), callback};
+      bindings_call_op(req, b->ops_fsyncdir, 4, tmp);
+    }
+    return;
+
+    // only used by the lowlevel backend
+    case OP_LOOKUP:
+    case OP_FORGET:
+    case OP_SETATTR:
+    case OP_LENGTH:
+    break;
+  }
+
+  completion_signal(&(req->done));
+}
+
+#if defined(NAN_MODULE_WORKER_ENABLED)
+static void bindings_shard_cleanup (void *data);
+#endif
+
+// shards are closed from their own loop, once the mount they serve is gone
+static void bindings_shard_closing (bindings_t *b) {
+  mutex_lock(&mutex);
+  int closing = b->closing;
+  mutex_unlock(&mutex);
+
+  if (!closing) return;
+#if defined(NAN_MODULE_WORKER_ENABLED)
+  node::RemoveEnvironmentCleanupHook(Isolate::GetCurrent(), bindings_shard_cleanup, b);
+#endif
+  uv_close((uv_handle_t*) &(b->async), &bindings_on_close);
+}
+
+static void bindings_dispatch (uv_async_t* handle, int status) {
+  bindings_t *b = (bindings_t *) handle->data;
+  bindings_req_t *req;
+
+  if (b->ops_batch == NULL) {
+    while ((req = bindings_ring_shift(b->pending)) != NULL) {
+      bindings_dispatch_req(req);
     }
+    if (b->shard) bindings_shard_closing(b);
     return;
   }
 
-  semaphore_signal(&(b->semaphore));
+  Nan::HandleScope scope;
+  Local<Array> batch = Nan::New<Array>();
+
+  bindings_batch = &batch;
+  while ((req = bindings_ring_shift(b->pending)) != NULL) {
+    bindings_dispatch_req(req);
+  }
+  bindings_batch = NULL;
+
+  if (batch->Length() > 0) {
+    Local<Value> tmp[] = {batch};
+    b->ops_batch->Call(1, tmp);
+  }
+  if (b->shard) bindings_shard_closing(b);
 }
 
 static int bindings_alloc () {
@@ -1194,32 +4774,37 @@ static int bindings_alloc () {
 
   if (free_index == -1 && bindings_mounted_count < 1024) free_index = bindings_mounted_count++;
   if (free_index != -1) {
-    bindings_t *b = bindings_mounted[free_index] = (bindings_t *) malloc(size);
-    memset(b, 0, size);
-    b->index = free_index;
-  }
-
-  return free_index;
-}
-
-NAN_METHOD(Mount) {
-  if (!info[0]->IsString()) return Nan::ThrowError("mnt must be a string");
-
-  mutex_lock(&mutex);
-  int index = bindings_alloc();
-  mutex_unlock(&mutex);
-
-  if (index == -1) return Nan::ThrowError("You cannot mount more than 1024 filesystem in one process");
+    bindings_t *b = bindings_mounted[free_index] = (bindings_t *) malloc(size);
+    memset(b, 0, size);
+    b->index = free_index;
+    completion_init(&(b->notified));
+  }
 
-  mutex_lock(&mutex);
-  bindings_t *b = bindings_mounted[index];
-  mutex_unlock(&mutex);
+  return free_index;
+}
 
-  memset(&empty_stat, 0, sizeof(empty_stat));
+// request slots and the loop side of the queue, closing b->async frees the mount
+static void bindings_init_reqs (bindings_t *b) {
+  semaphore_init(&(b->reqs_available));
+  b->reqs_free = bindings_ring_new(b->reqs_length);
+  b->pending = bindings_ring_new(b->reqs_length);
+  b->reqs = new bindings_req_t[b->reqs_length]();
+
+  for (int i = 0; i < b->reqs_length; i++) {
+    bindings_req_t *req = b->reqs + i;
+    req->id = b->index * BINDINGS_MAX_REQUESTS + i;
+    req->b = b;
+    completion_init(&(req->done));
+    bindings_ring_push(b->reqs_free, req);
+    semaphore_signal(&(b->reqs_available));
+  }
 
-  Nan::Utf8String path(info[0]);
-  Local<Object> ops = info[1].As<Object>();
+  uv_async_init(BINDINGS_LOOP, &(b->async), (uv_async_cb) bindings_dispatch);
+  b->async.data = b;
+}
 
+// the js side of a mount, also used for the shards a mount is split across
+static void bindings_set_ops (bindings_t *b, Local<Object> ops) {
   b->ops_init = LOOKUP_CALLBACK(ops, "init");
   b->ops_error = LOOKUP_CALLBACK(ops, "error");
   b->ops_access = LOOKUP_CALLBACK(ops, "access");
@@ -1255,9 +4840,126 @@ NAN_METHOD(Mount) {
   b->ops_mkdir = LOOKUP_CALLBACK(ops, "mkdir");
   b->ops_rmdir = LOOKUP_CALLBACK(ops, "rmdir");
   b->ops_destroy = LOOKUP_CALLBACK(ops, "destroy");
+  b->ops_lookup = LOOKUP_CALLBACK(ops, "lookup");
+  b->ops_forget = LOOKUP_CALLBACK(ops, "forget");
+  b->ops_setattr = LOOKUP_CALLBACK(ops, "setattr");
+  b->ops_batch = LOOKUP_CALLBACK(ops, "batch");
+
+  if (b->ops_batch != NULL) {
+    Local<Value> batch_ops = ops->Get(LOCAL_STRING("batchOps"));
+    if (batch_ops->IsArray()) {
+      Local<Array> names = batch_ops.As<Array>();
+      for (uint32_t i = 0; i < names->Length(); i++) {
+        Nan::Utf8String name(names->Get(i));
+        for (int op = 0; op < OP_LENGTH; op++) {
+          if (!strcmp(*name, bindings_op_names[op])) b->batch_ops |= 1ULL << op;
+        }
+      }
+    } else {
+      b->batch_ops = ~0ULL;
+    }
+    // these drive the mount callback and teardown in index.js
+    b->batch_ops &= ~((1ULL << OP_INIT) | (1ULL << OP_ERROR) | (1ULL << OP_DESTROY));
+  }
+
+  Local<Value> max_requests = ops->Get(LOCAL_STRING("maxRequests"));
+  b->reqs_length = max_requests->IsNumber() ? max_requests->Uint32Value() : BINDINGS_DEFAULT_REQUESTS;
+  if (b->reqs_length < 1) b->reqs_length = 1;
+  if (b->reqs_length > BINDINGS_MAX_REQUESTS) b->reqs_length = BINDINGS_MAX_REQUESTS;
+
+  Local<Value> path_cache = ops->Get(LOCAL_STRING("pathCache"));
+  if (path_cache->IsUndefined() || path_cache->BooleanValue()) {
+    b->intern = bindings_intern_new(path_cache->IsNumber() ? path_cache->Uint32Value() : BINDINGS_INTERN_SIZE);
+  }
+
+  Local<Value> copy_threshold = ops->Get(LOCAL_STRING("copyThreshold"));
+  b->copy_threshold = copy_threshold->IsNumber() ? copy_threshold->Uint32Value() : BINDINGS_COPY_THRESHOLD;
+
+  b->trace = bindings_trace_new();
+}
+
+#ifndef _WIN32
+// ops.plugin is a path or {path, options}. returns NULL with an exception thrown if it can't be loaded
+static struct fuse_bindings_plugin *bindings_plugin_load (Local<Value> value, void **handle) {
+  Local<Value> file = value;
+  std::string options;
+
+  if (value->IsObject()) {
+    Local<Object> obj = value.As<Object>();
+    Local<Value> opts = obj->Get(LOCAL_STRING("options"));
+    file = obj->Get(LOCAL_STRING("path"));
+    if (opts->IsString()) options = *Nan::Utf8String(opts);
+  }
+
+  if (!file->IsString()) {
+    Nan::ThrowError("plugin must be a path");
+    return NULL;
+  }
+
+  Nan::Utf8String path(file);
+  *handle = dlopen(*path, RTLD_NOW | RTLD_LOCAL);
+  if (*handle == NULL) {
+    Nan::ThrowError(dlerror());
+    return NULL;
+  }
+
+  fuse_bindings_plugin_init_t init = (fuse_bindings_plugin_init_t) dlsym(*handle, FUSE_BINDINGS_PLUGIN_INIT);
+  if (init == NULL) {
+    dlclose(*handle);
+    Nan::ThrowError("plugin does not export " FUSE_BINDINGS_PLUGIN_INIT);
+    return NULL;
+  }
+
+  struct fuse_bindings_plugin *plugin = (struct fuse_bindings_plugin *) calloc(1, sizeof(struct fuse_bindings_plugin));
+  plugin->version = FUSE_BINDINGS_PLUGIN_VERSION;
+
+  if (init(plugin, options.c_str()) < 0) {
+    free(plugin);
+    dlclose(*handle);
+    Nan::ThrowError("plugin init failed");
+    return NULL;
+  }
+
+  return plugin;
+}
+
+#endif
+
+NAN_METHOD(Mount) {
+  if (!info[0]->IsString()) return Nan::ThrowError("mnt must be a string");
+
+#ifndef _WIN32
+  // loaded first, so a plugin that fails to load doesn't leave a half set up mount behind
+  struct fuse_bindings_plugin *plugin = NULL;
+  void *plugin_handle = NULL;
+  Local<Value> plugin_value = info[1].As<Object>()->Get(LOCAL_STRING("plugin"));
+  if (!plugin_value->IsUndefined() && (plugin = bindings_plugin_load(plugin_value, &plugin_handle)) == NULL) return;
+#endif
+
+  mutex_lock(&mutex);
+  int index = bindings_alloc();
+  mutex_unlock(&mutex);
+
+  if (index == -1) {
+#ifndef _WIN32
+    if (plugin != NULL) bindings_plugin_unload(plugin, plugin_handle);
+#endif
+    return Nan::ThrowError("You cannot mount more than 1024 filesystem in one process");
+  }
+
+  mutex_lock(&mutex);
+  bindings_t *b = bindings_mounted[index];
+  mutex_unlock(&mutex);
+
+
+  Nan::Utf8String path(info[0]);
+  Local<Object> ops = info[1].As<Object>();
 
-  Local<Value> tmp[] = {Nan::New<Number>(index), Nan::New<FunctionTemplate>(OpCallback)->GetFunction()};
-  b->callback = new Nan::Callback(callback_constructor->Call(2, tmp).As<Function>());
+  bindings_set_ops(b, ops);
+#ifndef _WIN32
+  b->plugin = plugin;
+  b->plugin_handle = plugin_handle;
+#endif
 
   strcpy(b->mnt, *path);
   strcpy(b->mntopts, "-o");
@@ -1271,54 +4973,316 @@ NAN_METHOD(Mount) {
     }
   }
 
-  semaphore_init(&(b->semaphore));
-  semaphore_init(&(b->semaphore_readdir));
-  uv_async_init(uv_default_loop(), &(b->async), (uv_async_cb) bindings_dispatch);
-  b->async.data = b;
+  b->multithread = ops->Get(LOCAL_STRING("multithread"))->BooleanValue() ? 1 : 0;
+#ifndef _WIN32
+  b->lowlevel = ops->Get(LOCAL_STRING("lowlevel"))->BooleanValue() ? 1 : 0;
+#endif
+  b->readdir_paged = !b->lowlevel && ops->Get(LOCAL_STRING("readdirPaged"))->BooleanValue() ? 1 : 0;
+
+  if (ops->Get(LOCAL_STRING("stats"))->BooleanValue()) b->stats = bindings_stats_new(OP_LENGTH);
+
+  Local<Value> trace = ops->Get(LOCAL_STRING("trace"));
+  if (trace->BooleanValue()) bindings_trace_start(b->trace, trace->IsNumber() ? trace->Uint32Value() : BINDINGS_TRACE_SIZE);
+
+  Local<Value> spin = ops->Get(LOCAL_STRING("spin"));
+  b->spin = spin->IsNumber() ? spin->Int32Value() : 0;
+
+  Local<Value> attr_cache = ops->Get(LOCAL_STRING("attrCache"));
+  if (attr_cache->BooleanValue() && !b->lowlevel) {
+    b->attr_cache = bindings_attr_cache_new(attr_cache->IsNumber() ? attr_cache->Uint32Value() : BINDINGS_ATTR_CACHE_SIZE);
+  }
+
+  Local<Value> block_cache = ops->Get(LOCAL_STRING("blockCache"));
+  if (block_cache->BooleanValue() && !b->lowlevel) {
+    Local<Value> block_size = ops->Get(LOCAL_STRING("blockSize"));
+    b->block_cache = bindings_block_cache_new(
+      block_cache->IsNumber() ? block_cache->NumberValue() : BINDINGS_BLOCK_CACHE_SIZE,
+      block_size->IsNumber() && block_size->Uint32Value() > 0 ? block_size->Uint32Value() : BINDINGS_BLOCK_SIZE
+    );
+  }
+
+  Local<Value> write_behind = ops->Get(LOCAL_STRING("writeBehind"));
+  if (write_behind->BooleanValue() && !b->lowlevel) {
+    Local<Value> write_behind_age = ops->Get(LOCAL_STRING("writeBehindAge"));
+    b->write_behind = bindings_write_behind_new(
+      write_behind->IsNumber() ? write_behind->Uint32Value() : BINDINGS_WRITE_BEHIND_SIZE,
+      write_behind_age->IsNumber() ? write_behind_age->Uint32Value() : BINDINGS_WRITE_BEHIND_AGE
+    );
+  }
+
+  Local<Value> readahead = ops->Get(LOCAL_STRING("readAhead"));
+  if (readahead->BooleanValue() && !b->lowlevel) {
+    size_t max = readahead->IsNumber() ? readahead->Uint32Value() : BINDINGS_READAHEAD_SIZE;
+    b->readahead = bindings_readahead_new(std::max<size_t>(max, 2 * BINDINGS_READAHEAD_CHUNK));
+  }
+
+  Local<Value> shards = ops->Get(LOCAL_STRING("shards"));
+  if (shards->IsArray() && shards.As<Array>()->Length() > 0) {
+    Local<Array> list = shards.As<Array>();
+    b->shards = new bindings_t*[list->Length()];
+
+    mutex_lock(&mutex);
+    for (uint32_t i = 0; i < list->Length(); i++) {
+      int32_t shard_index = list->Get(i)->Int32Value();
+      bindings_t *shard = shard_index >= 0 && shard_index < bindings_mounted_count ? bindings_mounted[shard_index].load() : NULL;
+      if (shard == NULL || !shard->shard || shard->primary != NULL) continue;
+      // the fuse thread isn't running yet, so nothing is dispatched on the shard before this
+      shard->primary = b;
+      shard->lowlevel = b->lowlevel;
+      shard->readdir_paged = b->readdir_paged;
+      b->shards[b->shards_length++] = shard;
+    }
+    mutex_unlock(&mutex);
+  }
 
+  bindings_init_reqs(b);
   thread_create(&(b->thread), bindings_thread, b);
 }
 
+#if defined(NAN_MODULE_WORKER_ENABLED)
+static void bindings_shard_fail (bindings_req_t *req) {
+  req->result = -EIO;
+  if (req->complete != NULL) req->complete(req);
+  else completion_signal(&(req->done));
+}
+
+// the worker of a shard is exiting. requests stop being routed to it and the ones
+// it still has are failed, so no fuse thread waits on a loop that is going away
+static void bindings_shard_cleanup (void *data) {
+  bindings_t *b = (bindings_t *) data;
+  bindings_req_t *req;
+
+  mutex_lock(&mutex);
+  b->gone.store(1, std::memory_order_relaxed);
+  while ((req = bindings_ring_shift(b->pending)) != NULL) bindings_shard_fail(req);
+  for (int i = 0; i < b->reqs_length; i++) {
+    if (!b->reqs[i].inflight) continue;
+    b->reqs[i].inflight = 0;
+    bindings_shard_fail(b->reqs + i);
+  }
+  mutex_unlock(&mutex);
+
+  uv_close((uv_handle_t*) &(b->async), &bindings_on_close);
+}
+#endif
+
+// runs in a worker thread. sets up a shard on the worker's loop that a mount
+// can dispatch requests to, the returned index goes in ops.shards
+NAN_METHOD(Attach) {
+  mutex_lock(&mutex);
+  int index = bindings_alloc();
+  bindings_t *b = index == -1 ? NULL : bindings_mounted[index].load();
+  mutex_unlock(&mutex);
+
+  if (b == NULL) return Nan::ThrowError("You cannot mount more than 1024 filesystem in one process");
+
+  b->shard = 1;
+  bindings_set_ops(b, info[0].As<Object>());
+  bindings_init_reqs(b);
+#if defined(NAN_MODULE_WORKER_ENABLED)
+  node::AddEnvironmentCleanupHook(Isolate::GetCurrent(), bindings_shard_cleanup, b);
+#endif
+
+  info.GetReturnValue().Set(index);
+}
+
+// closes shards that never got mounted, the mount closes its own when it is freed
+NAN_METHOD(Detach) {
+  Local<Array> list = info[0].As<Array>();
+
+  mutex_lock(&mutex);
+  for (uint32_t i = 0; i < list->Length(); i++) {
+    int32_t shard_index = list->Get(i)->Int32Value();
+    bindings_t *shard = shard_index >= 0 && shard_index < bindings_mounted_count ? bindings_mounted[shard_index].load() : NULL;
+    if (shard == NULL || !shard->shard || shard->primary != NULL || shard->gone.load(std::memory_order_relaxed)) continue;
+    shard->closing = 1;
+    uv_async_send(&(shard->async));
+  }
+  mutex_unlock(&mutex);
+}
+
 class UnmountWorker : public Nan::AsyncWorker {
  public:
-  UnmountWorker(Nan::Callback *callback, char *path)
-    : Nan::AsyncWorker(callback), path(path), result(0) {}
+  UnmountWorker(Nan::Callback *callback, std::vector<std::string> &paths)
+    : Nan::AsyncWorker(callback), paths(paths), results(paths.size(), 0) {}
   ~UnmountWorker() {}
 
   void Execute () {
+    bindings_unmount(paths, results);
+  }
+
+  void HandleOKCallback () {
+    Nan::HandleScope scope;
+    Local<Array> list = Nan::New<Array>(results.size());
+    for (size_t i = 0; i < results.size(); i++) list->Set(i, Nan::New<Number>(results[i]));
+    Local<Value> tmp[] = {list};
+    callback->Call(1, tmp);
+  }
+
+ private:
+  std::vector<std::string> paths;
+  std::vector<int> results;
+};
+
+enum bindings_notify_t {
+  NOTIFY_INVAL_ENTRY = 0,
+  NOTIFY_INVAL_INODE,
+  NOTIFY_STORE,
+  NOTIFY_RETRIEVE
+};
+
+// notifications run off the loop thread, invalidating can make the kernel
+// send requests that js has to answer before the notify returns
+class NotifyWorker : public Nan::AsyncWorker {
+ public:
+  NotifyWorker(Nan::Callback *callback, const char *mnt, int type, uint64_t ino)
+    : Nan::AsyncWorker(callback), mnt(mnt), type(type), ino(ino), offset(0), length(0), data(NULL), result(0) {
+    retrieve.b = NULL;
+    retrieve.data = NULL;
+    retrieve.length = 0;
+    retrieve.result = 0;
+    completion_init(&(retrieve.done));
+  }
+  ~NotifyWorker() {
+    free(retrieve.data);
+  }
+
+  void Execute () {
+    mutex_lock(&mutex);
+    bindings_t *b = bindings_find_mounted((char *) mnt.c_str());
+    struct fuse_chan *ch = b != NULL ? b->ch : NULL;
+    result = b == NULL ? -ENOENT : (b->lowlevel ? -ENOTCONN : -ENOSYS);
+    if (ch != NULL) {
+      b->notifying++;
+      if (type == NOTIFY_RETRIEVE) {
+        retrieve.b = b;
+        bindings_retrieves.insert(&retrieve);
+      }
+    }
+    mutex_unlock(&mutex);
 
-    if(NULL == ch){
-        result = bindings_unmount(path);
-        free(path);
+    if (ch == NULL) return;
 
-        if (result != 0) {
-          SetErrorMessage("Error");
-        }
-     }
-     else {
-       fuse_unmount(path, ch);
-       fuse_session_remove_chan(ch);
+    switch (type) {
+#ifndef _WIN32
+      case NOTIFY_INVAL_ENTRY:
+      result = fuse_lowlevel_notify_inval_entry(ch, ino, name.c_str(), name.length());
+      break;
 
-     }
+      case NOTIFY_INVAL_INODE:
+      result = fuse_lowlevel_notify_inval_inode(ch, ino, offset, length);
+      break;
+#endif
+
+#ifdef BINDINGS_HAS_BUFVEC
+      case NOTIFY_STORE: {
+        struct fuse_bufvec bufv = FUSE_BUFVEC_INIT(length);
+        bufv.buf[0].mem = data;
+        result = fuse_lowlevel_notify_store(ch, ino, offset, &bufv, (enum fuse_buf_copy_flags) 0);
+      }
+      break;
+
+      case NOTIFY_RETRIEVE:
+      result = fuse_lowlevel_notify_retrieve(ch, ino, length, offset, &retrieve);
+      break;
+#endif
 
+      default:
+      result = -ENOSYS;
+      break;
+    }
+
+    mutex_lock(&mutex);
+    if (--b->notifying == 0 && b->ch == NULL) completion_signal(&(b->notified));
+    if (type == NOTIFY_RETRIEVE && result < 0) bindings_retrieves.erase(&retrieve);
+    mutex_unlock(&mutex);
+
+    // the data comes back as a request on the fuse thread, see bindings_ll_retrieve_reply
+    if (type == NOTIFY_RETRIEVE && result == 0) {
+      completion_wait(&(retrieve.done), 0);
+      result = retrieve.result;
+    }
   }
 
   void HandleOKCallback () {
     Nan::HandleScope scope;
-    callback->Call(0, NULL);
+
+    if (type == NOTIFY_RETRIEVE && result == 0) {
+      Local<Value> tmp[] = {Nan::New<Number>(0), Nan::NewBuffer(retrieve.data, retrieve.length).ToLocalChecked()};
+      retrieve.data = NULL; // owned by the buffer now
+      callback->Call(2, tmp);
+      return;
+    }
+
+    Local<Value> tmp[] = {Nan::New<Number>(result)};
+    callback->Call(1, tmp);
   }
 
- private:
-  char *path;
+  std::string mnt;
+  int type;
+  uint64_t ino;
+  std::string name;
+  FUSE_OFF_T offset;
+  size_t length;
+  char *data; // for store, kept alive with SaveToPersistent
   int result;
+  bindings_retrieve_t retrieve;
 };
 
+NAN_METHOD(NotifyInvalEntry) {
+  if (!info[0]->IsString()) return Nan::ThrowError("mnt must be a string");
+  if (!info[2]->IsString()) return Nan::ThrowError("name must be a string");
+  Nan::Utf8String mnt(info[0]);
+  Nan::Utf8String name(info[2]);
+
+  NotifyWorker *worker = new NotifyWorker(new Nan::Callback(info[3].As<Function>()), *mnt, NOTIFY_INVAL_ENTRY, info[1]->NumberValue());
+  worker->name = *name;
+  Nan::AsyncQueueWorker(worker);
+}
+
+NAN_METHOD(NotifyInvalInode) {
+  if (!info[0]->IsString()) return Nan::ThrowError("mnt must be a string");
+  Nan::Utf8String mnt(info[0]);
+
+  NotifyWorker *worker = new NotifyWorker(new Nan::Callback(info[4].As<Function>()), *mnt, NOTIFY_INVAL_INODE, info[1]->NumberValue());
+  worker->offset = info[2]->NumberValue();
+  worker->length = info[3]->NumberValue();
+  Nan::AsyncQueueWorker(worker);
+}
+
+NAN_METHOD(NotifyStore) {
+  if (!info[0]->IsString()) return Nan::ThrowError("mnt must be a string");
+  if (!node::Buffer::HasInstance(info[3])) return Nan::ThrowError("data must be a buffer");
+  Nan::Utf8String mnt(info[0]);
+
+  NotifyWorker *worker = new NotifyWorker(new Nan::Callback(info[4].As<Function>()), *mnt, NOTIFY_STORE, info[1]->NumberValue());
+  worker->offset = info[2]->NumberValue();
+  worker->data = node::Buffer::Data(info[3]);
+  worker->length = node::Buffer::Length(info[3]);
+  worker->SaveToPersistent("data", info[3]);
+  Nan::AsyncQueueWorker(worker);
+}
+
+NAN_METHOD(NotifyRetrieve) {
+  if (!info[0]->IsString()) return Nan::ThrowError("mnt must be a string");
+  Nan::Utf8String mnt(info[0]);
+
+  NotifyWorker *worker = new NotifyWorker(new Nan::Callback(info[4].As<Function>()), *mnt, NOTIFY_RETRIEVE, info[1]->NumberValue());
+  worker->offset = info[2]->NumberValue();
+  worker->length = info[3]->NumberValue();
+  Nan::AsyncQueueWorker(worker);
+}
+
 NAN_METHOD(SetCallback) {
   callback_constructor = new Nan::Callback(info[0].As<Function>());
 }
 
+NAN_METHOD(SetSlice) {
+  slice_constructor = new Nan::Callback(info[0].As<Function>());
+}
+
 NAN_METHOD(SetBuffer) {
-  buffer_constructor.Reset(info[0].As<Function>());
+  buffer_constructor->Reset(info[0].As<Function>());
 }
 
 NAN_METHOD(PopulateContext) {
@@ -1331,22 +5295,290 @@ NAN_METHOD(PopulateContext) {
 }
 
 NAN_METHOD(Unmount) {
-  if (!info[0]->IsString()) return Nan::ThrowError("mnt must be a string");
-  Nan::Utf8String path(info[0]);
+  if (!info[0]->IsArray()) return Nan::ThrowError("mnts must be an array");
+  Local<Array> mnts = info[0].As<Array>();
   Local<Function> callback = info[1].As<Function>();
 
-  char *path_alloc = (char *) malloc(1024);
-  strcpy(path_alloc, *path);
+  std::vector<std::string> paths;
+  for (uint32_t i = 0; i < mnts->Length(); i++) {
+    Nan::Utf8String path(mnts->Get(i));
+    paths.push_back(std::string(*path));
+  }
+
+  Nan::AsyncQueueWorker(new UnmountWorker(new Nan::Callback(callback), paths));
+}
+
+NAN_METHOD(Invalidate) {
+  if (!info[0]->IsString()) return Nan::ThrowError("mnt must be a string");
+  if (!info[1]->IsString()) return Nan::ThrowError("path must be a string");
+  Nan::Utf8String mnt(info[0]);
+  Nan::Utf8String path(info[1]);
+
+  mutex_lock(&mutex);
+  bindings_t *b = bindings_find_mounted(*mnt);
+  if (b != NULL) bindings_invalidate(b, *path, BINDINGS_INVALIDATE_CHILDREN);
+  mutex_unlock(&mutex);
+}
+
+static Local<Object> bindings_get_hist (bindings_hist_t *hist) {
+  uint64_t count = hist->count.load(std::memory_order_relaxed);
+  Local<Object> obj = Nan::New<Object>();
+  obj->Set(LOCAL_STRING("count"), Nan::New<Number>((double) count));
+  obj->Set(LOCAL_STRING("mean"), Nan::New<Number>(count ? (double) hist->sum.load(std::memory_order_relaxed) / count : 0));
+  obj->Set(LOCAL_STRING("max"), Nan::New<Number>((double) hist->max.load(std::memory_order_relaxed)));
+  obj->Set(LOCAL_STRING("p50"), Nan::New<Number>((double) bindings_hist_quantile(hist, 0.5)));
+  obj->Set(LOCAL_STRING("p90"), Nan::New<Number>((double) bindings_hist_quantile(hist, 0.9)));
+  obj->Set(LOCAL_STRING("p99"), Nan::New<Number>((double) bindings_hist_quantile(hist, 0.99)));
+  obj->Set(LOCAL_STRING("p999"), Nan::New<Number>((double) bindings_hist_quantile(hist, 0.999)));
+  return obj;
+}
+
+NAN_METHOD(Stats) {
+  if (!info[0]->IsString()) return Nan::ThrowError("mnt must be a string");
+  Nan::Utf8String mnt(info[0]);
+
+  static const char *phases[] = {"send", "queue", "js", "post", "total"};
+
+  mutex_lock(&mutex);
+  bindings_t *b = bindings_find_mounted(*mnt);
+  if (b == NULL || b->stats == NULL) {
+    mutex_unlock(&mutex);
+    return info.GetReturnValue().SetNull();
+  }
+
+  Local<Object> result = Nan::New<Object>();
+
+  for (int op = 0; op < OP_LENGTH; op++) {
+    bindings_op_stats_t *stats = b->stats + op;
+    if (!stats->phases[PHASE_TOTAL].count.load(std::memory_order_relaxed)) continue;
+
+    Local<Object> entry = Nan::New<Object>();
+    for (int phase = 0; phase < PHASE_LENGTH; phase++) {
+      entry->Set(LOCAL_STRING(phases[phase]), bindings_get_hist(stats->phases + phase));
+    }
+
+    Local<Object> errors = Nan::New<Object>();
+    for (int err = 0; err < BINDINGS_STATS_ERRNOS; err++) {
+      uint64_t count = stats->errors[err].load(std::memory_order_relaxed);
+      if (count) errors->Set(Nan::New<Number>(err), Nan::New<Number>((double) count));
+    }
+    entry->Set(LOCAL_STRING("errors"), errors);
+
+    if (op == OP_READ || op == OP_WRITE) {
+      entry->Set(LOCAL_STRING("bytes"), Nan::New<Number>((double) stats->bytes.load(std::memory_order_relaxed)));
+    }
+
+    result->Set(Nan::New(bindings_op_strings[op]), entry);
+  }
+
+  mutex_unlock(&mutex);
+  info.GetReturnValue().Set(result);
+}
+
+// micro benchmarks of the hot paths, see bench/micro.js. the round trip ones go through a
+// mount without fuse behind it, a threadpool thread plays the fuse thread
+
+static int bindings_benchmark_filler (void *buf, const char *name, const struct FUSE_STAT *stat, FUSE_OFF_T off) {
+  (*(uint32_t *) buf)++;
+  return 0;
+}
+
+static void bindings_benchmark_noop () {}
+static void (*volatile bindings_benchmark_fn)() = bindings_benchmark_noop;
+static char bindings_benchmark_data[65536];
+
+class BenchmarkWorker : public Nan::AsyncWorker {
+ public:
+  BenchmarkWorker(Nan::Callback *callback, bindings_t *b, bindings_ops_t op, uint32_t iterations)
+    : Nan::AsyncWorker(callback), b(b), op(op), iterations(iterations), elapsed(0) {}
+  ~BenchmarkWorker() {}
+
+  void Execute () {
+    struct FUSE_STAT stat;
+    uint32_t filled = 0;
+    uint64_t start = uv_hrtime();
+
+    for (uint32_t i = 0; i < iterations; i++) {
+      bindings_req_t *req = bindings_req_alloc(b);
+      req->op = op;
+      req->path = (char *) "/";
+      req->mode = 0;
+      req->data = op == OP_READDIR ? (void *) &filled : (void *) &stat;
+      req->filler = bindings_benchmark_filler;
+      bindings_call(req);
+    }
+
+    elapsed = uv_hrtime() - start;
+  }
+
+  void HandleOKCallback () {
+    Nan::HandleScope scope;
+    uv_close((uv_handle_t*) &(b->async), &bindings_on_close);
+    Local<Value> tmp[] = {Nan::Null(), Nan::New<Number>((double) elapsed / iterations)};
+    callback->Call(2, tmp);
+  }
+
+ private:
+  bindings_t *b;
+  bindings_ops_t op;
+  uint32_t iterations;
+  uint64_t elapsed;
+};
+
+// benchmark(name, iterations, arg, [cb]) returns (or calls back with) the ns per iteration
+NAN_METHOD(Benchmark) {
+  if (!info[0]->IsString()) return Nan::ThrowError("name must be a string");
+  Nan::Utf8String name(info[0]);
+  uint32_t iterations = info[1]->IsNumber() ? info[1]->Uint32Value() : 0;
+  if (iterations == 0) return Nan::ThrowError("iterations must be a positive number");
+
+  // one request through uv_async_send, dispatch and the completion. arg is the js
+  // handler, or null for the native baseline that completes without calling into js
+  bindings_ops_t op = OP_LENGTH;
+  if (!strcmp(*name, "roundtrip")) op = OP_ACCESS;
+  else if (!strcmp(*name, "getattr")) op = OP_GETATTR;
+  else if (!strcmp(*name, "readdir")) op = OP_READDIR;
+
+  if (op != OP_LENGTH) {
+    if (!info[3]->IsFunction()) return Nan::ThrowError("callback must be a function");
+
+    mutex_lock(&mutex);
+    int index = bindings_alloc();
+    bindings_t *b = index == -1 ? NULL : bindings_mounted[index].load();
+    mutex_unlock(&mutex);
+    if (b == NULL) return Nan::ThrowError("You cannot mount more than 1024 filesystem in one process");
+
+    Nan::Callback *handler = info[2]->IsFunction() ? new Nan::Callback(info[2].As<Function>()) : NULL;
+    if (op == OP_ACCESS) b->ops_access = handler;
+    else if (op == OP_GETATTR) b->ops_getattr = handler;
+    else b->ops_readdir = handler;
+
+    b->reqs_length = 1;
+    b->copy_threshold = BINDINGS_COPY_THRESHOLD;
+    b->intern = bindings_intern_new(BINDINGS_INTERN_SIZE);
+    b->trace = bindings_trace_new();
+    bindings_init_reqs(b);
+
+    Nan::AsyncQueueWorker(new BenchmarkWorker(new Nan::Callback(info[3].As<Function>()), b, op, iterations));
+    return;
+  }
+
+  uint64_t start = uv_hrtime();
+
+  if (!strcmp(*name, "noop")) { // an indirect native call, the baseline of the synchronous ones
+    for (uint32_t i = 0; i < iterations; i++) bindings_benchmark_fn();
+  } else if (!strcmp(*name, "set_stat")) {
+    if (!info[2]->IsObject()) return Nan::ThrowError("stat must be an object");
+    Local<Object> obj = info[2].As<Object>();
+    struct FUSE_STAT stat;
+    for (uint32_t i = 0; i < iterations; i++) bindings_set_stat(&stat, obj);
+  } else if (!strcmp(*name, "copy_stat")) { // what set_stat would cost if js handed us a struct stat
+    struct FUSE_STAT src, dst;
+    memset(&src, 0, sizeof(src));
+    for (uint32_t i = 0; i < iterations; i++) {
+      memcpy(&dst, &src, sizeof(dst));
+      bindings_benchmark_fn();
+    }
+  } else if (!strcmp(*name, "buffer")) {
+    size_t length = info[2]->IsNumber() ? info[2]->Uint32Value() : 4096;
+    if (length > sizeof(bindings_benchmark_data)) length = sizeof(bindings_benchmark_data);
+    for (uint32_t i = 0; i < iterations; i++) {
+      Nan::HandleScope scope;
+      bindings_buffer(bindings_benchmark_data, length);
+    }
+  } else {
+    return Nan::ThrowError("unknown benchmark");
+  }
+
+  info.GetReturnValue().Set(Nan::New<Number>((double) (uv_hrtime() - start) / iterations));
+}
+
+NAN_METHOD(TraceStart) {
+  if (!info[0]->IsString()) return Nan::ThrowError("mnt must be a string");
+  Nan::Utf8String mnt(info[0]);
+
+  mutex_lock(&mutex);
+  bindings_t *b = bindings_find_mounted(*mnt);
+  int result = b != NULL ? bindings_trace_start(b->trace, info[1]->IsNumber() ? info[1]->Uint32Value() : BINDINGS_TRACE_SIZE) : 0;
+  mutex_unlock(&mutex);
+
+  if (b == NULL) return Nan::ThrowError("not mounted");
+  if (result < 0) return Nan::ThrowError("could not allocate the trace buffer");
+}
+
+NAN_METHOD(TraceStop) {
+  if (!info[0]->IsString()) return Nan::ThrowError("mnt must be a string");
+  Nan::Utf8String mnt(info[0]);
+
+  mutex_lock(&mutex);
+  bindings_t *b = bindings_find_mounted(*mnt);
+  if (b != NULL) bindings_trace_stop(b->trace);
+  mutex_unlock(&mutex);
+}
+
+// the recorded events as a buffer of doubles, BINDINGS_TRACE_FIELDS per event
+NAN_METHOD(TraceSnapshot) {
+  if (!info[0]->IsString()) return Nan::ThrowError("mnt must be a string");
+  Nan::Utf8String mnt(info[0]);
+
+  mutex_lock(&mutex);
+  bindings_t *b = bindings_find_mounted(*mnt);
+  bindings_trace_t *trace = b != NULL ? b->trace : NULL;
+  if (trace == NULL || trace->events == NULL) {
+    mutex_unlock(&mutex);
+    return info.GetReturnValue().SetNull();
+  }
+
+  double *events = (double *) malloc((trace->mask + 1) * BINDINGS_TRACE_FIELDS * sizeof(double));
+  size_t length = events != NULL ? bindings_trace_snapshot(trace, events) : 0;
+  mutex_unlock(&mutex);
 
-  Nan::AsyncQueueWorker(new UnmountWorker(new Nan::Callback(callback), path_alloc));
+  Local<Object> buf = Nan::CopyBuffer((const char *) events, length * BINDINGS_TRACE_FIELDS * sizeof(double)).ToLocalChecked();
+  free(events);
+  info.GetReturnValue().Set(buf);
 }
 
 void Init(Handle<Object> exports) {
+  bindings_keys = new Nan::Persistent<String>[KEY_LENGTH];
+  bindings_op_strings = new Nan::Persistent<String>[OP_LENGTH];
+  buffer_constructor = new Nan::Persistent<Function>();
+
+  for (int i = 0; i < KEY_LENGTH; i++) {
+#if NODE_MODULE_VERSION >= IOJS_3_0_MODULE_VERSION
+    bindings_keys[i].Reset(String::NewFromUtf8(Isolate::GetCurrent(), bindings_key_names[i], NewStringType::kInternalized).ToLocalChecked());
+#else
+    bindings_keys[i].Reset(LOCAL_STRING(bindings_key_names[i]));
+#endif
+  }
+  Local<Array> op_names = Nan::New<Array>(OP_LENGTH);
+  for (int i = 0; i < OP_LENGTH; i++) {
+    bindings_op_strings[i].Reset(LOCAL_STRING(bindings_op_names[i]));
+    op_names->Set(i, Nan::New(bindings_op_strings[i]));
+  }
+
   exports->Set(LOCAL_STRING("setCallback"), Nan::New<FunctionTemplate>(SetCallback)->GetFunction());
   exports->Set(LOCAL_STRING("setBuffer"), Nan::New<FunctionTemplate>(SetBuffer)->GetFunction());
+  exports->Set(LOCAL_STRING("setSlice"), Nan::New<FunctionTemplate>(SetSlice)->GetFunction());
   exports->Set(LOCAL_STRING("mount"), Nan::New<FunctionTemplate>(Mount)->GetFunction());
   exports->Set(LOCAL_STRING("unmount"), Nan::New<FunctionTemplate>(Unmount)->GetFunction());
+  exports->Set(LOCAL_STRING("attach"), Nan::New<FunctionTemplate>(Attach)->GetFunction());
+  exports->Set(LOCAL_STRING("detach"), Nan::New<FunctionTemplate>(Detach)->GetFunction());
   exports->Set(LOCAL_STRING("populateContext"), Nan::New<FunctionTemplate>(PopulateContext)->GetFunction());
+  exports->Set(LOCAL_STRING("invalidate"), Nan::New<FunctionTemplate>(Invalidate)->GetFunction());
+  exports->Set(LOCAL_STRING("notifyInvalEntry"), Nan::New<FunctionTemplate>(NotifyInvalEntry)->GetFunction());
+  exports->Set(LOCAL_STRING("notifyInvalInode"), Nan::New<FunctionTemplate>(NotifyInvalInode)->GetFunction());
+  exports->Set(LOCAL_STRING("notifyStore"), Nan::New<FunctionTemplate>(NotifyStore)->GetFunction());
+  exports->Set(LOCAL_STRING("notifyRetrieve"), Nan::New<FunctionTemplate>(NotifyRetrieve)->GetFunction());
+  exports->Set(LOCAL_STRING("stats"), Nan::New<FunctionTemplate>(Stats)->GetFunction());
+  exports->Set(LOCAL_STRING("traceStart"), Nan::New<FunctionTemplate>(TraceStart)->GetFunction());
+  exports->Set(LOCAL_STRING("traceStop"), Nan::New<FunctionTemplate>(TraceStop)->GetFunction());
+  exports->Set(LOCAL_STRING("traceSnapshot"), Nan::New<FunctionTemplate>(TraceSnapshot)->GetFunction());
+  exports->Set(LOCAL_STRING("opNames"), op_names);
+  exports->Set(LOCAL_STRING("benchmark"), Nan::New<FunctionTemplate>(Benchmark)->GetFunction());
 }
 
+#if defined(NAN_MODULE_WORKER_ENABLED)
+NAN_MODULE_WORKER_ENABLED(fuse_bindings, Init)
+#else
 NODE_MODULE(fuse_bindings, Init)
+#endif
@@ -6,6 +6,18 @@ var path = require('path')
 
 var noop = function () {}
 var call = function (cb) { cb() }
+var unbatched = function () { arguments[arguments.length - 1](exports.ENOSYS) }
+
+var errnoName = function (code) {
+  var names = Object.keys(exports)
+  for (var i = 0; i < names.length; i++) {
+    if (/^E[A-Z0-9]+$/.test(names[i]) && exports[names[i]] === code) return names[i]
+  }
+  return null
+}
+
+var TRACE_FIELDS = 14
+var TRACE_PHASES = ['send', 'queue', 'js', 'post']
 
 var IS_OSX = os.platform() === 'darwin'
 var OSX_FOLDER_ICON = '/System/Library/CoreServices/CoreTypes.bundle/Contents/Resources/GenericFolderIcon.icns'
@@ -22,6 +34,9 @@ fuse.setBuffer(FuseBuffer)
 fuse.setCallback(function (index, callback) {
   return callback.bind(null, index)
 })
+fuse.setSlice(function (buf, length) {
+  return buf.slice(0, length)
+})
 
 exports.context = function () {
   var ctx = {}
@@ -49,10 +64,17 @@ exports.mount = function (mnt, ops, opts, cb) {
   }
 
   var init = ops.init || call
-  ops.init = function (next) {
+  ops.init = function (conn, next) {
     callback()
-    if (init.length > 1) init(mnt, next) // backwards compat for now
-    else init(next)
+    if (init.length > 2) {
+      init(mnt, conn, function (err, settings) {
+        next(err, settings || conn) // mutating conn in place works as well
+      })
+    } else if (init.length > 1) {
+      init(mnt, next) // backwards compat for now
+    } else {
+      init(next)
+    }
   }
 
   var error = ops.error || call
@@ -61,13 +83,41 @@ exports.mount = function (mnt, ops, opts, cb) {
     error(next)
   }
 
+  if (ops.batch && ops.batchOps) { // batch only ops still need a handler to be registered
+    ops.batchOps.forEach(function (name) {
+      if (!ops[name]) ops[name] = unbatched
+    })
+  }
+
+  if (ops.readdir && ops.readdir.length === 4 && !ops.lowlevel) ops.readdirPaged = true
+
+  if (ops.shards) { // the fuse thread only serves ops the mount itself has a handler for
+    ops.shards.forEach(function (shard) {
+      if (shard.readdirPaged && !ops.lowlevel) ops.readdirPaged = true
+      shard.ops.forEach(function (name) {
+        if (!ops[name]) ops[name] = unbatched
+      })
+    })
+    ops.shards = ops.shards.map(function (shard) {
+      return shard.index
+    })
+  }
+
   if (!ops.getattr) { // we need this for unmount to work on osx
     ops.getattr = function (path, cb) {
-      if (path !== '/') return cb(fuse.EPERM)
+      if (path !== (ops.lowlevel ? 1 : '/')) return cb(fuse.EPERM)
       cb(null, {mtime: new Date(0), atime: new Date(0), ctime: new Date(0), mode: 16877, size: 4096})
     }
   }
 
+  var start = function () {
+    try {
+      fuse.mount(mnt, ops)
+    } catch (err) { // i.e. ops.plugin failed to load
+      cb(err)
+    }
+  }
+
   var mount = function () {
     // TODO: I got a feeling this can be done better
     if (os.platform() !== 'win32') {
@@ -76,11 +126,11 @@ exports.mount = function (mnt, ops, opts, cb) {
         if (!stat.isDirectory()) return cb(new Error('Mountpoint is not a directory'))
         fs.stat(path.join(mnt, '..'), function (_, parent) {
           if (parent && parent.dev !== stat.dev) return cb(new Error('Mountpoint in use'))
-          fuse.mount(mnt, ops)
+          start()
         })
       })
     } else {
-      fuse.mount(mnt, ops)
+      start()
     }
   }
 
@@ -88,8 +138,212 @@ exports.mount = function (mnt, ops, opts, cb) {
   exports.unmount(mnt, mount)
 }
 
+var SHARD_OPS = [
+  'access', 'statfs', 'getattr', 'fgetattr', 'flush', 'fsync', 'fsyncdir', 'readdir', 'truncate', 'ftruncate',
+  'readlink', 'chown', 'chmod', 'mknod', 'setxattr', 'getxattr', 'listxattr', 'removexattr', 'open', 'opendir',
+  'read', 'write', 'release', 'releasedir', 'create', 'utimens', 'unlink', 'rename', 'link', 'symlink', 'mkdir',
+  'rmdir', 'lookup', 'forget', 'setattr'
+]
+
+exports.attach = function (ops) { // call this in a worker thread, pass the result to the main thread
+  ops = xtend(ops) // clone
+
+  if (ops.batch && ops.batchOps) {
+    ops.batchOps.forEach(function (name) {
+      if (!ops[name]) ops[name] = unbatched
+    })
+  }
+
+  return {
+    index: fuse.attach(ops),
+    ops: SHARD_OPS.filter(function (name) {
+      return !!ops[name]
+    }),
+    readdirPaged: !!(ops.readdir && ops.readdir.length === 4)
+  }
+}
+
+exports.detach = function (shards) {
+  fuse.detach(shards.map(function (shard) {
+    return shard.index
+  }))
+}
+
+var mountResults = function (mnts, errors, cb) {
+  var err = null
+  var results = mnts.map(function (mnt, i) {
+    if (errors[i] && !err) err = errors[i]
+    return {mnt: mnt, error: errors[i] || null}
+  })
+  cb(err, results)
+}
+
+exports.mountMany = function (mounts, cb) {
+  if (!cb) cb = noop
+
+  var mnts = mounts.map(function (m) {
+    return path.resolve(m.mnt)
+  })
+  var forced = mnts.filter(function (mnt, i) {
+    return (mounts[i].ops && mounts[i].ops.force) || (mounts[i].opts && mounts[i].opts.force)
+  })
+
+  // unmount everything that is forced in one go instead of one worker each
+  exports.unmountMany(forced, function () {
+    var errors = new Array(mounts.length)
+    var missing = mounts.length
+    if (!missing) return mountResults(mnts, errors, cb)
+
+    mounts.forEach(function (m, i) {
+      exports.mount(mnts[i], m.ops, xtend(m.opts, {force: false}), function (err) {
+        errors[i] = err
+        if (--missing === 0) mountResults(mnts, errors, cb)
+      })
+    })
+  })
+}
+
+var unmountError = function (result) {
+  if (!result) return null
+  var err = new Error(errnoName(result) || 'Unmount failed')
+  err.errno = result
+  return err
+}
+
 exports.unmount = function (mnt, cb) {
-  fuse.unmount(path.resolve(mnt), cb)
+  fuse.unmount([path.resolve(mnt)], function (results) {
+    if (cb) cb(unmountError(results[0]))
+  })
+}
+
+exports.unmountMany = function (mnts, cb) {
+  if (!cb) cb = noop
+  mnts = mnts.map(function (mnt) {
+    return path.resolve(mnt)
+  })
+  if (!mnts.length) return setImmediate(cb, null, [])
+
+  fuse.unmount(mnts, function (results) {
+    mountResults(mnts, results.map(unmountError), cb)
+  })
+}
+
+exports.invalidate = function (mnt, name) {
+  fuse.invalidate(path.resolve(mnt), name)
+}
+
+var notifyCallback = function (cb) {
+  return function (result, buf) {
+    if (!cb) return
+    if (result < 0) {
+      var err = new Error(errnoName(result) || 'Notify failed')
+      err.errno = result
+      return cb(err)
+    }
+    cb(null, buf)
+  }
+}
+
+exports.notify = {}
+
+exports.notify.invalEntry = function (mnt, parent, name, cb) {
+  fuse.notifyInvalEntry(path.resolve(mnt), parent, name, notifyCallback(cb))
+}
+
+exports.notify.invalInode = function (mnt, ino, offset, length, cb) {
+  if (typeof offset === 'function') return exports.notify.invalInode(mnt, ino, 0, 0, offset)
+  fuse.notifyInvalInode(path.resolve(mnt), ino, offset || 0, length || 0, notifyCallback(cb))
+}
+
+exports.notify.store = function (mnt, ino, offset, data, cb) {
+  fuse.notifyStore(path.resolve(mnt), ino, offset, data, notifyCallback(cb))
+}
+
+exports.notify.retrieve = function (mnt, ino, offset, length, cb) {
+  fuse.notifyRetrieve(path.resolve(mnt), ino, offset, length, notifyCallback(cb))
+}
+
+exports.stats = function (mnt) {
+  var stats = fuse.stats(path.resolve(mnt))
+  if (!stats) return null
+
+  Object.keys(stats).forEach(function (op) {
+    var errors = stats[op].errors
+    stats[op].errors = {}
+    Object.keys(errors).forEach(function (errno) {
+      stats[op].errors[errnoName(-errno) || errno] = errors[errno]
+    })
+  })
+
+  return stats
+}
+
+exports.trace = {}
+
+exports.trace.start = function (mnt, size) {
+  fuse.traceStart(path.resolve(mnt), size)
+}
+
+exports.trace.stop = function (mnt) {
+  fuse.traceStop(path.resolve(mnt))
+}
+
+exports.trace.events = function (mnt, opts) { // in chrome trace format
+  if (!opts) opts = {}
+  mnt = path.resolve(mnt)
+
+  var buf = fuse.traceSnapshot(mnt)
+  if (!buf) return null
+
+  var count = buf.length / (TRACE_FIELDS * 8)
+  var fields = new Array(TRACE_FIELDS)
+  var newest = 0
+  var i = 0
+
+  for (i = 0; i < count; i++) newest = Math.max(newest, buf.readDoubleLE((i * TRACE_FIELDS + 4) * 8))
+
+  var oldest = opts.seconds ? newest - opts.seconds * 1e9 : 0
+  var events = [{name: 'process_name', ph: 'M', pid: 1, tid: 0, args: {name: mnt}}]
+
+  for (i = 0; i < count; i++) {
+    for (var j = 0; j < TRACE_FIELDS; j++) fields[j] = buf.readDoubleLE((i * TRACE_FIELDS + j) * 8)
+    if (fields[4] < oldest) continue
+
+    var slot = fields[6]
+    events.push({
+      name: fuse.opNames[fields[5]],
+      cat: 'op',
+      ph: 'X',
+      pid: 1,
+      tid: slot,
+      ts: fields[0] / 1000,
+      dur: (fields[4] - fields[0]) / 1000,
+      args: {
+        result: fields[7],
+        pid: fields[8],
+        path: ('0000000' + fields[9].toString(16)).slice(-8),
+        ino: fields[10],
+        fh: fields[11],
+        offset: fields[12],
+        length: fields[13]
+      }
+    })
+
+    for (var p = 0; p < TRACE_PHASES.length; p++) {
+      events.push({name: TRACE_PHASES[p], cat: 'phase', ph: 'X', pid: 1, tid: slot, ts: fields[p] / 1000, dur: (fields[p + 1] - fields[p]) / 1000})
+    }
+  }
+
+  return {traceEvents: events, displayTimeUnit: 'ns'}
+}
+
+exports.trace.dump = function (mnt, file, opts, cb) {
+  if (typeof opts === 'function') return exports.trace.dump(mnt, file, null, opts)
+  if (!cb) cb = noop
+
+  var trace = exports.trace.events(mnt, opts)
+  if (!trace) return process.nextTick(cb, new Error('Not mounted'))
+  fs.writeFile(file, JSON.stringify(trace), cb)
 }
 
 exports.errno = function (code) {
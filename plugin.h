@@ -0,0 +1,51 @@
+#ifndef FUSE_BINDINGS_PLUGIN_H
+#define FUSE_BINDINGS_PLUGIN_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+
+// Native handlers loaded from a shared library, see ops.plugin. The library
+// exports fuse_bindings_plugin_init, which is called once per mount and fills in
+// the ops it wants to serve. Those are called on the fuse threads before the js
+// handler (concurrently with ops.multithread), and every call can either answer
+// the op, with a result like the js callback would get, or return
+// FUSE_BINDINGS_DEFER to pass that one call on to js. Ops left NULL always go to js.
+//
+// Only fields are ever appended to the struct, and version is bumped when they are.
+// Not used with ops.lowlevel or on Windows.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FUSE_BINDINGS_PLUGIN_VERSION 1
+#define FUSE_BINDINGS_DEFER INT_MIN
+
+struct fuse_bindings_plugin {
+  uint32_t version; // set by the bindings before init, the version they were built with
+  void *data; // set by the plugin, passed back to every op
+
+  int (*getattr) (void *data, const char *path, struct stat *stat);
+  int (*readlink) (void *data, const char *path, char *buf, size_t len);
+  int (*statfs) (void *data, const char *path, struct statvfs *statfs);
+  int (*open) (void *data, const char *path, int flags, uint64_t *fh); // fh is what js would have returned
+  int (*read) (void *data, const char *path, uint64_t fh, char *buf, size_t len, int64_t offset);
+  int (*write) (void *data, const char *path, uint64_t fh, const char *buf, size_t len, int64_t offset);
+  int (*release) (void *data, const char *path, uint64_t fh);
+
+  void (*destroy) (void *data); // once the filesystem is unmounted
+};
+
+// options is ops.plugin.options, or an empty string. return < 0 to fail the mount
+typedef int (*fuse_bindings_plugin_init_t) (struct fuse_bindings_plugin *plugin, const char *options);
+
+#define FUSE_BINDINGS_PLUGIN_INIT "fuse_bindings_plugin_init"
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,45 @@
+#include "stats.h"
+
+#include <stdlib.h>
+#include <new>
+
+bindings_op_stats_t *bindings_stats_new (int length) {
+  bindings_op_stats_t *stats = (bindings_op_stats_t *) calloc(length, sizeof(bindings_op_stats_t));
+  if (stats == NULL) return NULL;
+  for (int i = 0; i < length; i++) new (stats + i) bindings_op_stats_t();
+  return stats;
+}
+
+void bindings_stats_destroy (bindings_op_stats_t *stats) {
+  free(stats);
+}
+
+static uint64_t bindings_hist_bucket_max (int bucket) {
+  if (bucket < BINDINGS_HIST_SUB) return bucket;
+  int shift = bucket / BINDINGS_HIST_SUB - 1;
+  uint64_t min = (uint64_t) (BINDINGS_HIST_SUB + bucket % BINDINGS_HIST_SUB) << shift;
+  return min + ((uint64_t) 1 << shift) - 1;
+}
+
+uint64_t bindings_hist_quantile (bindings_hist_t *hist, double q) {
+  // counters keep moving while we read them, so go by what the buckets add up to
+  uint64_t total = 0;
+  for (int i = 0; i < BINDINGS_HIST_BUCKETS; i++) total += hist->buckets[i].load(std::memory_order_relaxed);
+  if (total == 0) return 0;
+
+  uint64_t rank = (uint64_t) (q * total + 0.5);
+  if (rank < 1) rank = 1;
+  if (rank > total) rank = total;
+
+  uint64_t seen = 0;
+  for (int i = 0; i < BINDINGS_HIST_BUCKETS; i++) {
+    seen += hist->buckets[i].load(std::memory_order_relaxed);
+    if (seen >= rank) {
+      uint64_t value = bindings_hist_bucket_max(i);
+      uint64_t max = hist->max.load(std::memory_order_relaxed);
+      return value < max ? value : max;
+    }
+  }
+
+  return hist->max.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,85 @@
+#include <stdint.h>
+#include <atomic>
+
+// Log-linear latency histograms, hdr style. Values below BINDINGS_HIST_SUB get a
+// bucket each, above that every power of two is split into BINDINGS_HIST_SUB
+// buckets, so any recorded value is off by at most 1/BINDINGS_HIST_SUB (25%).
+// Everything is a relaxed atomic so fuse threads can record without locking.
+
+#define BINDINGS_HIST_SUB_BITS 2
+#define BINDINGS_HIST_SUB (1 << BINDINGS_HIST_SUB_BITS)
+#define BINDINGS_HIST_MAX_BITS 40 // ~18 minutes in ns, larger values land in the last bucket
+#define BINDINGS_HIST_BUCKETS ((BINDINGS_HIST_MAX_BITS - BINDINGS_HIST_SUB_BITS + 1) * BINDINGS_HIST_SUB)
+#define BINDINGS_STATS_ERRNOS 128 // errors above this are counted under 0
+
+struct bindings_hist_t {
+  std::atomic<uint64_t> count;
+  std::atomic<uint64_t> sum;
+  std::atomic<uint64_t> max;
+  std::atomic<uint64_t> buckets[BINDINGS_HIST_BUCKETS];
+};
+
+// where a request spends its time, see bindings_stats_record
+enum bindings_phase_t {
+  PHASE_SEND = 0, // fuse thread entry (incl. waiting for a free slot) until uv_async_send
+  PHASE_QUEUE, // uv_async_send until bindings_dispatch gets to it
+  PHASE_JS, // js handler until its callback is called
+  PHASE_POST, // native work after the callback (SetDirWorker etc) until the fuse thread wakes
+  PHASE_TOTAL,
+  PHASE_LENGTH
+};
+
+struct bindings_op_stats_t {
+  bindings_hist_t phases[PHASE_LENGTH];
+  std::atomic<uint64_t> errors[BINDINGS_STATS_ERRNOS];
+  std::atomic<uint64_t> bytes; // read and write only
+};
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static inline int bindings_hist_msb (uint64_t value) {
+#if defined(_MSC_VER) && defined(_M_X64)
+  unsigned long index;
+  _BitScanReverse64(&index, value);
+  return (int) index;
+#elif defined(_MSC_VER)
+  unsigned long index;
+  if (value >> 32) {
+    _BitScanReverse(&index, (unsigned long) (value >> 32));
+    return (int) index + 32;
+  }
+  _BitScanReverse(&index, (unsigned long) value);
+  return (int) index;
+#else
+  return 63 - __builtin_clzll(value);
+#endif
+}
+
+static inline int bindings_hist_bucket (uint64_t value) {
+  if (value < BINDINGS_HIST_SUB) return (int) value;
+  int msb = bindings_hist_msb(value);
+  if (msb >= BINDINGS_HIST_MAX_BITS) return BINDINGS_HIST_BUCKETS - 1;
+  int shift = msb - BINDINGS_HIST_SUB_BITS;
+  return (shift + 1) * BINDINGS_HIST_SUB + (int) ((value >> shift) & (BINDINGS_HIST_SUB - 1));
+}
+
+static inline void bindings_hist_record (bindings_hist_t *hist, uint64_t value) {
+  hist->count.fetch_add(1, std::memory_order_relaxed);
+  hist->sum.fetch_add(value, std::memory_order_relaxed);
+  hist->buckets[bindings_hist_bucket(value)].fetch_add(1, std::memory_order_relaxed);
+
+  uint64_t max = hist->max.load(std::memory_order_relaxed);
+  while (value > max && !hist->max.compare_exchange_weak(max, value, std::memory_order_relaxed));
+}
+
+static inline void bindings_stats_error (bindings_op_stats_t *stats, int err) {
+  stats->errors[err > 0 && err < BINDINGS_STATS_ERRNOS ? err : 0].fetch_add(1, std::memory_order_relaxed);
+}
+
+bindings_op_stats_t *bindings_stats_new (int length);
+void bindings_stats_destroy (bindings_op_stats_t *stats);
+
+// highest value that lands in the same bucket as the value at quantile q (0 - 1)
+uint64_t bindings_hist_quantile (bindings_hist_t *hist, double q);
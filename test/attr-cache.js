@@ -0,0 +1,108 @@
+var mnt = require('./fixtures/mnt')
+var stat = require('./fixtures/stat')
+var fuse = require('../')
+var tape = require('tape')
+var fs = require('fs')
+var path = require('path')
+
+tape('attr cache', function (t) {
+  var calls = 0
+  var exists = true
+
+  var ops = {
+    force: true,
+    attrCache: true,
+    options: ['attr_timeout=0', 'entry_timeout=0', 'negative_timeout=0'],
+    getattr: function (path, cb) {
+      if (path === '/') return cb(null, stat({mode: 'dir', size: 4096}))
+      if (path === '/hello') {
+        calls++
+        if (!exists) return cb(fuse.ENOENT, null, 60000)
+        return cb(null, stat({mode: 'file', size: 11}), 60000)
+      }
+      return cb(fuse.ENOENT)
+    },
+    unlink: function (path, cb) {
+      exists = false
+      cb(0)
+    }
+  }
+
+  fuse.mount(mnt, ops, function (err) {
+    t.error(err, 'no error')
+
+    fs.stat(path.join(mnt, 'hello'), function (err, st) {
+      t.error(err, 'no error')
+      t.same(st.size, 11, 'correct size')
+
+      fs.stat(path.join(mnt, 'hello'), function (err, st) {
+        t.error(err, 'no error')
+        t.same(calls, 1, 'second stat served from cache')
+
+        fuse.invalidate(mnt, '/hello')
+        fs.stat(path.join(mnt, 'hello'), function (err) {
+          t.error(err, 'no error')
+          t.same(calls, 2, 'invalidate drops the entry')
+
+          fs.unlink(path.join(mnt, 'hello'), function (err) {
+            t.error(err, 'no error')
+
+            fs.stat(path.join(mnt, 'hello'), function (err) {
+              t.ok(err, 'file is gone')
+              t.same(calls, 3, 'unlink drops the entry')
+
+              fs.stat(path.join(mnt, 'hello'), function (err) {
+                t.ok(err, 'file is still gone')
+                t.same(calls, 3, 'ENOENT served from cache')
+
+                fuse.unmount(mnt, function () {
+                  t.end()
+                })
+              })
+            })
+          })
+        })
+      })
+    })
+  })
+})
+
+tape('readdir primes the attr cache', function (t) {
+  var calls = 0
+
+  var ops = {
+    force: true,
+    attrCache: true,
+    options: ['attr_timeout=0', 'entry_timeout=0'],
+    getattr: function (path, cb) {
+      if (path === '/') return cb(null, stat({mode: 'dir', size: 4096}))
+      calls++
+      return cb(fuse.ENOENT)
+    },
+    readdir: function (path, cb) {
+      cb(0, [
+        {name: 'a', stat: stat({mode: 'file', size: 1}), ttl: 60000},
+        {name: 'b', stat: stat({mode: 'file', size: 2}), ttl: 60000}
+      ])
+    }
+  }
+
+  fuse.mount(mnt, ops, function (err) {
+    t.error(err, 'no error')
+
+    fs.readdir(mnt, function (err, list) {
+      t.error(err, 'no error')
+      t.same(list.sort(), ['a', 'b'], 'lists entries')
+
+      fs.stat(path.join(mnt, 'b'), function (err, st) {
+        t.error(err, 'no error')
+        t.same(st.size, 2, 'stat from readdir')
+        t.same(calls, 0, 'no getattr call')
+
+        fuse.unmount(mnt, function () {
+          t.end()
+        })
+      })
+    })
+  })
+})
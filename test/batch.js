@@ -0,0 +1,46 @@
+var mnt = require('./fixtures/mnt')
+var stat = require('./fixtures/stat')
+var fuse = require('../')
+var tape = require('tape')
+var fs = require('fs')
+var path = require('path')
+
+tape('batch', function (t) {
+  var batched = 0
+
+  var ops = {
+    force: true,
+    multithread: true,
+    batchOps: ['getattr'],
+    batch: function (requests) {
+      requests.forEach(function (req) {
+        t.same(req.op, 'getattr', 'only batched ops')
+        batched++
+        var p = req.args[0]
+        if (p === '/') return req.callback(0, stat({mode: 'dir', size: 4096}))
+        if (/^\/file-\d$/.test(p)) {
+          t.same(req.context.uid, process.getuid(), 'carries the context of the stat')
+          return req.callback(0, stat({mode: 'file', size: 1}))
+        }
+        req.callback(fuse.ENOENT)
+      })
+    }
+  }
+
+  fuse.mount(mnt, ops, function (err) {
+    t.error(err, 'no error')
+
+    var missing = 5
+    for (var i = 0; i < 5; i++) {
+      fs.stat(path.join(mnt, 'file-' + i), function (err, st) {
+        t.error(err, 'no error')
+        t.ok(st.isFile(), 'is a file')
+        if (--missing) return
+        t.ok(batched >= 5, 'getattrs went through ops.batch')
+        fuse.unmount(mnt, function () {
+          t.end()
+        })
+      })
+    }
+  })
+})
@@ -0,0 +1,62 @@
+var mnt = require('./fixtures/mnt')
+var stat = require('./fixtures/stat')
+var fuse = require('../')
+var tape = require('tape')
+var fs = require('fs')
+var path = require('path')
+
+tape('block cache', function (t) {
+  var content = 'hello world'
+  var reads = 0
+
+  var ops = {
+    force: true,
+    blockCache: true,
+    blockSize: 4,
+    getattr: function (path, cb) {
+      if (path === '/') return cb(0, stat({mode: 'dir', size: 4096}))
+      if (path === '/test') return cb(0, stat({mode: 'file', size: content.length}))
+      return cb(fuse.ENOENT)
+    },
+    open: function (path, flags, cb) {
+      cb(0, 42)
+    },
+    read: function (path, fd, buf, len, pos, cb) {
+      reads++
+      t.same(pos % 4, 0, 'reads whole blocks')
+      var str = content.slice(pos, pos + len)
+      if (!str) return cb(0)
+      buf.write(str)
+      return cb(str.length)
+    }
+  }
+
+  fuse.mount(mnt, ops, function (err) {
+    t.error(err, 'no error')
+
+    fs.readFile(path.join(mnt, 'test'), function (err, buf) {
+      t.error(err, 'no error')
+      t.same(buf, new Buffer('hello world'), 'read file')
+      var first = reads
+
+      fs.readFile(path.join(mnt, 'test'), function (err, buf) {
+        t.error(err, 'no error')
+        t.same(buf, new Buffer('hello world'), 'read file again')
+        t.same(reads, first, 'served from the cache')
+
+        content = 'HELLO WORLD'
+        fuse.invalidate(mnt, '/test')
+
+        fs.readFile(path.join(mnt, 'test'), function (err, buf) {
+          t.error(err, 'no error')
+          t.same(buf, new Buffer('HELLO WORLD'), 'read the new content')
+          t.ok(reads > first, 'invalidate dropped the blocks')
+
+          fuse.unmount(mnt, function () {
+            t.end()
+          })
+        })
+      })
+    })
+  })
+})
@@ -0,0 +1,46 @@
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include "../../plugin.h"
+
+// serves /native from c, everything else is left to js
+
+static const char *hello = "hello from c";
+
+static int plugin_getattr (void *data, const char *path, struct stat *stat) {
+  if (strcmp(path, "/native")) return FUSE_BINDINGS_DEFER;
+  memset(stat, 0, sizeof(struct stat));
+  stat->st_mode = S_IFREG | 0644;
+  stat->st_size = strlen(hello);
+  stat->st_uid = getuid();
+  stat->st_gid = getgid();
+  return 0;
+}
+
+static int plugin_open (void *data, const char *path, int flags, uint64_t *fh) {
+  if (strcmp(path, "/native")) return FUSE_BINDINGS_DEFER;
+  *fh = 42;
+  return 0;
+}
+
+static int plugin_read (void *data, const char *path, uint64_t fh, char *buf, size_t len, int64_t offset) {
+  if (fh != 42) return FUSE_BINDINGS_DEFER;
+  size_t size = strlen(hello);
+  if (offset >= (int64_t) size) return 0;
+  if (len > size - offset) len = size - offset;
+  memcpy(buf, hello + offset, len);
+  return len;
+}
+
+static int plugin_release (void *data, const char *path, uint64_t fh) {
+  return fh == 42 ? 0 : FUSE_BINDINGS_DEFER;
+}
+
+int fuse_bindings_plugin_init (struct fuse_bindings_plugin *plugin, const char *options) {
+  if (plugin->version < 1) return -1;
+  plugin->getattr = plugin_getattr;
+  plugin->open = plugin_open;
+  plugin->read = plugin_read;
+  plugin->release = plugin_release;
+  return 0;
+}
@@ -0,0 +1,92 @@
+var mnt = require('./fixtures/mnt')
+var stat = require('./fixtures/stat')
+var fuse = require('../')
+var tape = require('tape')
+var fs = require('fs')
+var path = require('path')
+
+tape('lowlevel readdir and read', function (t) {
+  var ops = {
+    force: true,
+    lowlevel: true,
+    lookup: function (parent, name, cb) {
+      if (parent === 1 && name === 'hello') return cb(0, {ino: 2, attr: stat({mode: 'file', size: 11})})
+      return cb(fuse.ENOENT, {entryTimeout: 1})
+    },
+    getattr: function (ino, cb) {
+      if (ino === 1) return cb(0, stat({mode: 'dir', size: 4096}))
+      if (ino === 2) return cb(0, stat({mode: 'file', size: 11}))
+      return cb(fuse.ENOENT)
+    },
+    readdir: function (ino, fd, offset, cb) {
+      if (ino === 1) return cb(0, [{name: 'hello', ino: 2}].slice(offset))
+      return cb(fuse.ENOTDIR)
+    },
+    open: function (ino, flags, cb) {
+      cb(0, 42)
+    },
+    read: function (ino, fd, buf, len, pos, cb) {
+      t.same(fd, 42, 'fd is passed through')
+      var str = 'hello world'.slice(pos, pos + len)
+      if (!str) return cb(0)
+      buf.write(str)
+      return cb(str.length)
+    }
+  }
+
+  fuse.mount(mnt, ops, function (err) {
+    t.error(err, 'no error')
+
+    fs.readdir(mnt, function (err, list) {
+      t.error(err, 'no error')
+      t.same(list, ['hello'], 'lists the directory')
+
+      fs.readFile(path.join(mnt, 'hello'), 'utf-8', function (err, data) {
+        t.error(err, 'no error')
+        t.same(data, 'hello world', 'read the file')
+
+        fs.stat(path.join(mnt, 'missing'), function (err) {
+          t.ok(err, 'missing file errors')
+
+          fuse.unmount(mnt, function () {
+            t.end()
+          })
+        })
+      })
+    })
+  })
+})
+
+tape('lowlevel readdir is paged by offset', function (t) {
+  var names = []
+  var offsets = []
+  for (var i = 0; i < 2000; i++) names.push('file-' + i)
+
+  var ops = {
+    force: true,
+    lowlevel: true,
+    getattr: function (ino, cb) {
+      if (ino === 1) return cb(0, stat({mode: 'dir', size: 4096}))
+      return cb(fuse.ENOENT)
+    },
+    readdir: function (ino, fd, offset, cb) {
+      offsets.push(offset)
+      cb(0, names.slice(offset, offset + 256))
+    }
+  }
+
+  fuse.mount(mnt, ops, function (err) {
+    t.error(err, 'no error')
+    fs.readdir(mnt, function (err, list) {
+      t.error(err, 'no error')
+      t.same(list.sort(), names.slice().sort(), 'lists every entry')
+      t.same(offsets[0], 0, 'starts at offset 0')
+      t.ok(offsets.every(function (offset, i) { return !i || offset > offsets[i - 1] }), 'never lists from the start again')
+      t.same(offsets[offsets.length - 1], names.length, 'ends with an empty page')
+
+      fuse.unmount(mnt, function () {
+        t.end()
+      })
+    })
+  })
+})
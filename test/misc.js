@@ -41,3 +41,24 @@ tape('mnt point must be directory', function (t) {
     t.end()
   })
 })
+
+tape('init gets the connection settings', function (t) {
+  var ops = {
+    force: true,
+    init: function (mnt, conn, cb) {
+      t.same(typeof conn.protoMajor, 'number', 'has protocol version')
+      t.ok(Array.isArray(conn.capable), 'capable is an array')
+      t.ok(Array.isArray(conn.want), 'want is an array')
+      t.ok(conn.maxWrite > 0, 'has max write')
+      if (conn.capable.indexOf('big_writes') > -1) conn.want.push('big_writes')
+      cb(0)
+    }
+  }
+
+  fuse.mount(mnt, ops, function (err) {
+    t.error(err, 'no error')
+    fuse.unmount(mnt, function () {
+      t.end()
+    })
+  })
+})
@@ -0,0 +1,69 @@
+var mnt = require('./fixtures/mnt')
+var fuse = require('../')
+var tape = require('tape')
+var fs = require('fs')
+var path = require('path')
+
+var mnts = [0, 1, 2, 3, 4, 5, 6, 7].map(function (i) {
+  var dir = path.join(mnt, 'many-' + i)
+  try {
+    fs.mkdirSync(dir)
+  } catch (err) {
+    // do nothing
+  }
+  return dir
+})
+
+tape('mountMany + unmountMany', function (t) {
+  var mounts = mnts.map(function (dir) {
+    return {mnt: dir, ops: {force: true}}
+  })
+
+  fuse.mountMany(mounts, function (err, results) {
+    t.error(err, 'no error')
+    t.same(results.length, mnts.length, 'one result per mount')
+    results.forEach(function (r, i) {
+      t.same(r.mnt, mnts[i], 'in order')
+      t.same(r.error, null, 'mounted')
+    })
+
+    fs.stat(mnts[0], function (err, st) {
+      t.error(err, 'no error')
+      fs.stat(mnt, function (_, parent) {
+        t.ok(st.dev !== parent.dev, 'is a mount')
+
+        fuse.unmountMany(mnts, function (err, results) {
+          t.error(err, 'no error')
+          results.forEach(function (r) {
+            t.same(r.error, null, 'unmounted')
+          })
+          t.end()
+        })
+      })
+    })
+  })
+})
+
+tape('mountMany reports failures per mount', function (t) {
+  var mounts = [
+    {mnt: mnts[0], ops: {force: true}},
+    {mnt: mnt + '.does-not-exist', ops: {}}
+  ]
+
+  fuse.mountMany(mounts, function (err, results) {
+    t.ok(err, 'had error')
+    t.same(results[0].error, null, 'first one mounted')
+    t.ok(results[1].error, 'second one failed')
+    fuse.unmountMany([mnts[0]], function (err) {
+      t.error(err, 'no error')
+      t.end()
+    })
+  })
+})
+
+tape('unmount of something not mounted fails', function (t) {
+  fuse.unmount(mnts[1], function (err) {
+    t.ok(err, 'had error')
+    t.end()
+  })
+})
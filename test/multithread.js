@@ -0,0 +1,105 @@
+var mnt = require('./fixtures/mnt')
+var stat = require('./fixtures/stat')
+var fuse = require('../')
+var tape = require('tape')
+var fs = require('fs')
+var path = require('path')
+var proc = require('child_process')
+
+tape('multithread reads are concurrent', function (t) {
+  var files = ['a', 'b', 'c', 'd']
+  var inflight = 0
+  var maxInflight = 0
+
+  var ops = {
+    force: true,
+    multithread: true,
+    readdir: function (path, cb) {
+      if (path === '/') return cb(null, files)
+      return cb(fuse.ENOENT)
+    },
+    getattr: function (path, cb) {
+      if (path === '/') return cb(null, stat({mode: 'dir', size: 4096}))
+      if (files.indexOf(path.slice(1)) > -1) return cb(null, stat({mode: 'file', size: 11}))
+      return cb(fuse.ENOENT)
+    },
+    open: function (path, flags, cb) {
+      cb(0, 42)
+    },
+    read: function (path, fd, buf, len, pos, cb) {
+      var str = 'hello world'.slice(pos, pos + len)
+      if (!str) return cb(0)
+      inflight++
+      maxInflight = Math.max(inflight, maxInflight)
+      setTimeout(function () {
+        inflight--
+        buf.write(str)
+        cb(str.length)
+      }, 100)
+    }
+  }
+
+  fuse.mount(mnt, ops, function (err) {
+    t.error(err, 'no error')
+
+    var missing = files.length
+    files.forEach(function (name) {
+      fs.readFile(path.join(mnt, name), function (err, buf) {
+        t.error(err, 'no error')
+        t.same(buf, new Buffer('hello world'), 'read ' + name)
+        if (--missing) return
+        t.ok(maxInflight > 1, 'reads were in flight at the same time')
+        fuse.unmount(mnt, function () {
+          t.end()
+        })
+      })
+    })
+  })
+})
+
+tape('multithread context is per request', function (t) {
+  var files = ['a', 'b', 'c', 'd']
+  var pids = {}
+  var threw = 0
+
+  var ops = {
+    force: true,
+    multithread: true,
+    getattr: function (path, cb) {
+      if (path === '/') return cb(null, stat({mode: 'dir', size: 4096}))
+      if (files.indexOf(path.slice(1)) === -1) return cb(fuse.ENOENT)
+      var ctx = fuse.context()
+      setTimeout(function () {
+        try {
+          fuse.context()
+        } catch (err) {
+          threw++
+        }
+        pids[path] = ctx.pid
+        cb(null, stat({mode: 'file', size: 11}))
+      }, 100)
+    }
+  }
+
+  fuse.mount(mnt, ops, function (err) {
+    t.error(err, 'no error')
+
+    var children = {}
+    var missing = files.length
+    files.forEach(function (name) {
+      var child = proc.spawn('stat', [path.join(mnt, name)])
+      children['/' + name] = child.pid
+      child.on('exit', function (code) {
+        t.same(code, 0, 'stat ' + name)
+        if (--missing) return
+        files.forEach(function (name) {
+          t.same(pids['/' + name], children['/' + name], 'context of ' + name + ' has its caller')
+        })
+        t.ok(threw > 0, 'context throws outside of the handler')
+        fuse.unmount(mnt, function () {
+          t.end()
+        })
+      })
+    })
+  })
+})
@@ -0,0 +1,97 @@
+var mnt = require('./fixtures/mnt')
+var stat = require('./fixtures/stat')
+var fuse = require('../')
+var tape = require('tape')
+var fs = require('fs')
+var path = require('path')
+var os = require('os')
+
+tape('notify', function (t) {
+  var content = 'hello world'
+  var reads = 0
+
+  var ops = {
+    force: true,
+    lowlevel: true,
+    options: ['kernel_cache'],
+    lookup: function (parent, name, cb) {
+      if (parent === 1 && name === 'hello') return cb(0, {ino: 2, attr: stat({mode: 'file', size: content.length}), attrTimeout: 60, entryTimeout: 60})
+      return cb(fuse.ENOENT)
+    },
+    getattr: function (ino, cb) {
+      if (ino === 1) return cb(0, stat({mode: 'dir', size: 4096}))
+      if (ino === 2) return cb(0, stat({mode: 'file', size: content.length}))
+      return cb(fuse.ENOENT)
+    },
+    open: function (ino, flags, cb) {
+      cb(0, 42)
+    },
+    read: function (ino, fd, buf, len, pos, cb) {
+      reads++
+      var str = content.slice(pos, pos + len)
+      if (!str) return cb(0)
+      buf.write(str)
+      return cb(str.length)
+    }
+  }
+
+  fuse.mount(mnt, ops, function (err) {
+    t.error(err, 'no error')
+
+    fs.readFile(path.join(mnt, 'hello'), 'utf-8', function (err, data) {
+      t.error(err, 'no error')
+      t.same(data, 'hello world', 'read the file')
+
+      content = 'HELLO WORLD'
+      fuse.notify.invalInode(mnt, 2, function (err) {
+        t.error(err, 'no error')
+
+        fs.readFile(path.join(mnt, 'hello'), 'utf-8', function (err, data) {
+          t.error(err, 'no error')
+          t.same(data, 'HELLO WORLD', 'read the new content')
+
+          if (os.platform() !== 'linux') return done()
+
+          fuse.notify.store(mnt, 2, 0, new Buffer('howdy world'), function (err) {
+            t.error(err, 'no error')
+            var before = reads
+
+            fuse.notify.retrieve(mnt, 2, 0, 11, function (err, buf) {
+              t.error(err, 'no error')
+              t.same(buf.toString(), 'howdy world', 'retrieved what was stored')
+
+              fs.readFile(path.join(mnt, 'hello'), 'utf-8', function (err, data) {
+                t.error(err, 'no error')
+                t.same(data, 'howdy world', 'served from the page cache')
+                t.same(reads, before, 'without reading')
+                done()
+              })
+            })
+          })
+        })
+      })
+    })
+  })
+
+  function done () {
+    fuse.notify.invalEntry(mnt, 1, 'hello', function (err) {
+      t.error(err, 'no error')
+      fuse.unmount(mnt, function () {
+        t.end()
+      })
+    })
+  }
+})
+
+tape('notify needs lowlevel', function (t) {
+  fuse.mount(mnt, {force: true}, function (err) {
+    t.error(err, 'no error')
+    fuse.notify.invalInode(mnt, 1, function (err) {
+      t.ok(err, 'had error')
+      t.same(err.errno, fuse.ENOSYS, 'not supported')
+      fuse.unmount(mnt, function () {
+        t.end()
+      })
+    })
+  })
+})
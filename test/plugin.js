@@ -0,0 +1,70 @@
+var mnt = require('./fixtures/mnt')
+var stat = require('./fixtures/stat')
+var fuse = require('../')
+var tape = require('tape')
+var fs = require('fs')
+var os = require('os')
+var path = require('path')
+var proc = require('child_process')
+
+// built here instead of in binding.gyp so installs don't compile a test fixture
+var plugin = path.join(os.tmpdir(), 'fuse-bindings-plugin-' + process.pid + '.so')
+proc.execFileSync(process.env.CC || 'cc', ['-shared', '-fPIC', '-o', plugin, path.join(__dirname, 'fixtures/plugin.c')])
+
+tape('plugin answers its ops natively and defers the rest', function (t) {
+  var jsPaths = []
+
+  var ops = {
+    force: true,
+    plugin: plugin,
+    readdir: function (path, cb) {
+      if (path === '/') return cb(null, ['native', 'js'])
+      return cb(fuse.ENOENT)
+    },
+    getattr: function (path, cb) {
+      jsPaths.push(path)
+      if (path === '/') return cb(null, stat({mode: 'dir', size: 4096}))
+      if (path === '/js') return cb(null, stat({mode: 'file', size: 11}))
+      return cb(fuse.ENOENT)
+    },
+    open: function (path, flags, cb) {
+      jsPaths.push(path)
+      cb(0, 10)
+    },
+    read: function (path, fd, buf, len, pos, cb) {
+      t.same(fd, 10, 'js only reads its own handles')
+      var str = 'hello world'.slice(pos, pos + len)
+      if (!str) return cb(0)
+      buf.write(str)
+      return cb(str.length)
+    }
+  }
+
+  fuse.mount(mnt, ops, function (err) {
+    t.error(err, 'no error')
+
+    fs.readFile(path.join(mnt, 'native'), function (err, buf) {
+      t.error(err, 'no error')
+      t.same(buf, new Buffer('hello from c'), 'read from the plugin')
+
+      fs.readFile(path.join(mnt, 'js'), function (err, buf) {
+        t.error(err, 'no error')
+        t.same(buf, new Buffer('hello world'), 'read from js')
+        t.ok(jsPaths.indexOf('/native') === -1, 'js never saw /native')
+        t.ok(jsPaths.indexOf('/js') > -1, 'js saw /js')
+
+        fuse.unmount(mnt, function () {
+          t.end()
+        })
+      })
+    })
+  })
+})
+
+tape('mount fails for a missing plugin', function (t) {
+  fuse.mount(mnt, {force: true, plugin: plugin + '.does-not-exist'}, function (err) {
+    t.ok(err, 'had error')
+    fs.unlinkSync(plugin)
+    t.end()
+  })
+})
@@ -0,0 +1,61 @@
+var mnt = require('./fixtures/mnt')
+var stat = require('./fixtures/stat')
+var fuse = require('../')
+var tape = require('tape')
+var fs = require('fs')
+var path = require('path')
+
+tape('read ahead', function (t) {
+  var content = new Buffer(2 * 1024 * 1024)
+  for (var i = 0; i < content.length; i++) content[i] = i % 251
+
+  var inflight = 0
+  var maxInflight = 0
+
+  var ops = {
+    force: true,
+    readAhead: true,
+    getattr: function (path, cb) {
+      if (path === '/') return cb(0, stat({mode: 'dir', size: 4096}))
+      if (path === '/blob') return cb(0, stat({mode: 'file', size: content.length}))
+      return cb(fuse.ENOENT)
+    },
+    open: function (path, flags, cb) {
+      cb(0, 42)
+    },
+    read: function (path, fd, buf, len, pos, cb) {
+      inflight++
+      maxInflight = Math.max(inflight, maxInflight)
+      setTimeout(function () { // a slow backend
+        inflight--
+        var slice = content.slice(pos, pos + len)
+        slice.copy(buf)
+        cb(slice.length)
+      }, 5)
+    }
+  }
+
+  fuse.mount(mnt, ops, function (err) {
+    t.error(err, 'no error')
+
+    fs.readFile(path.join(mnt, 'blob'), function (err, buf) {
+      t.error(err, 'no error')
+      t.ok(buf.equals(content), 'read the whole file')
+      t.ok(maxInflight > 1, 'reads were issued ahead of the reader')
+
+      fs.open(path.join(mnt, 'blob'), 'r', function (err, fd) {
+        t.error(err, 'no error')
+        var small = new Buffer(100)
+        fs.read(fd, small, 0, 100, 1000000, function (err, bytes) {
+          t.error(err, 'no error')
+          t.ok(small.equals(content.slice(1000000, 1000100)), 'random reads still work')
+          fs.close(fd, function () {
+            fuse.unmount(mnt, function () {
+              t.end()
+            })
+          })
+        })
+      })
+    })
+  })
+})
@@ -4,6 +4,7 @@ var fuse = require('../')
 var tape = require('tape')
 var fs = require('fs')
 var path = require('path')
+var os = require('os')
 var concat = require('concat-stream')
 
 tape('read', function (t) {
@@ -59,3 +60,122 @@ tape('read', function (t) {
     })
   })
 })
+
+tape('read from fd', function (t) {
+  var backing = path.join(os.tmpdir(), 'fuse-bindings-backing-' + process.pid)
+  fs.writeFileSync(backing, 'hello world')
+  var backingFd = fs.openSync(backing, 'r')
+
+  var ops = {
+    force: true,
+    getattr: function (path, cb) {
+      if (path === '/') return cb(null, stat({mode: 'dir', size: 4096}))
+      if (path === '/test') return cb(null, stat({mode: 'file', size: 11}))
+      return cb(fuse.ENOENT)
+    },
+    read: function (path, fd, buf, len, pos, cb) {
+      cb(Math.max(0, Math.min(len, 11 - pos)), {fd: backingFd, position: pos})
+    }
+  }
+
+  fuse.mount(mnt, ops, function (err) {
+    t.error(err, 'no error')
+
+    fs.createReadStream(path.join(mnt, 'test'), {start: 6, end: 10}).pipe(concat(function (buf) {
+      t.same(buf, new Buffer('world'), 'read served from fd')
+
+      fuse.unmount(mnt, function () {
+        fs.closeSync(backingFd)
+        fs.unlinkSync(backing)
+        t.end()
+      })
+    }))
+  })
+})
+
+tape('read from fd closed right after the callback', function (t) {
+  var backing = path.join(os.tmpdir(), 'fuse-bindings-backing-' + process.pid)
+  var decoy = path.join(os.tmpdir(), 'fuse-bindings-decoy-' + process.pid)
+  fs.writeFileSync(backing, 'hello world')
+  fs.writeFileSync(decoy, 'xxxxxxxxxxx')
+  var decoys = []
+
+  var ops = {
+    force: true,
+    getattr: function (path, cb) {
+      if (path === '/') return cb(null, stat({mode: 'dir', size: 4096}))
+      if (path === '/test') return cb(null, stat({mode: 'file', size: 11}))
+      return cb(fuse.ENOENT)
+    },
+    read: function (path, fd, buf, len, pos, cb) {
+      var backingFd = fs.openSync(backing, 'r')
+      cb(Math.max(0, Math.min(len, 11 - pos)), {fd: backingFd, position: pos})
+      fs.closeSync(backingFd)
+      decoys.push(fs.openSync(decoy, 'r')) // most likely reuses the fd number
+    }
+  }
+
+  fuse.mount(mnt, ops, function (err) {
+    t.error(err, 'no error')
+
+    fs.readFile(path.join(mnt, 'test'), function (err, buf) {
+      t.error(err, 'no error')
+      t.same(buf, new Buffer('hello world'), 'read served from the fd as it was')
+
+      fuse.unmount(mnt, function () {
+        decoys.forEach(function (fd) {
+          fs.closeSync(fd)
+        })
+        fs.unlinkSync(backing)
+        fs.unlinkSync(decoy)
+        t.end()
+      })
+    })
+  })
+})
+
+tape('passthrough fd', function (t) {
+  var backing = path.join(os.tmpdir(), 'fuse-bindings-passthrough-' + process.pid)
+  fs.writeFileSync(backing, 'hello world')
+
+  var ops = {
+    force: true,
+    getattr: function (path, cb) {
+      if (path === '/') return cb(null, stat({mode: 'dir', size: 4096}))
+      if (path === '/test') return cb(null, stat({mode: 'file', size: 11}))
+      return cb(fuse.ENOENT)
+    },
+    open: function (path, flags, cb) {
+      cb(0, {fh: 1, passthroughFd: fs.openSync(backing, 'r')})
+    },
+    read: function (path, fd, buf, len, pos, cb) {
+      t.fail('read should not reach js')
+      cb(0)
+    },
+    release: function (path, fd, cb) {
+      t.same(fd, 1, 'release is still passed on')
+      cb(0)
+      done()
+    }
+  }
+
+  // the release is sent after the close returns
+  var missing = 2
+  var done = function () {
+    if (--missing) return
+    fuse.unmount(mnt, function () {
+      fs.unlinkSync(backing)
+      t.end()
+    })
+  }
+
+  fuse.mount(mnt, ops, function (err) {
+    t.error(err, 'no error')
+
+    fs.readFile(path.join(mnt, 'test'), function (err, buf) {
+      t.error(err, 'no error')
+      t.same(buf, new Buffer('hello world'), 'read served natively')
+      done()
+    })
+  })
+})
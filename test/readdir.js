@@ -0,0 +1,45 @@
+var mnt = require('./fixtures/mnt')
+var stat = require('./fixtures/stat')
+var fuse = require('../')
+var tape = require('tape')
+var fs = require('fs')
+
+tape('paged readdir', function (t) {
+  var total = 5000
+  var chunks = 0
+
+  var ops = {
+    force: true,
+    getattr: function (path, cb) {
+      if (path === '/') return cb(0, stat({mode: 'dir', size: 4096}))
+      return cb(fuse.ENOENT)
+    },
+    opendir: function (path, flags, cb) {
+      cb(0, 42)
+    },
+    readdir: function (path, fd, offset, cb) {
+      t.same(fd, 42, 'fd is passed')
+      chunks++
+      var names = []
+      for (var i = offset; i < Math.min(offset + 100, total); i++) names.push('file-' + i)
+      if (!names.length) return cb(0, [])
+      cb(0, names, offset + names.length)
+    }
+  }
+
+  fuse.mount(mnt, ops, function (err) {
+    t.error(err, 'no error')
+
+    fs.readdir(mnt, function (err, list) {
+      t.error(err, 'no error')
+      t.same(list.length, total, 'lists every entry')
+      t.same(list[0], 'file-0', 'first entry')
+      t.same(list[total - 1], 'file-' + (total - 1), 'last entry')
+      t.ok(chunks >= total / 100, 'listed in chunks')
+
+      fuse.unmount(mnt, function () {
+        t.end()
+      })
+    })
+  })
+})
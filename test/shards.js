@@ -0,0 +1,178 @@
+var mnt = require('./fixtures/mnt')
+var fuse = require('../')
+var tape = require('tape')
+var fs = require('fs')
+var path = require('path')
+var worker = require('worker_threads')
+
+var source = [
+  'var fuse = require(' + JSON.stringify(path.join(__dirname, '..')) + ')',
+  'var worker = require("worker_threads")',
+  'var stat = require(' + JSON.stringify(path.join(__dirname, 'fixtures/stat')) + ')',
+  'worker.parentPort.postMessage(fuse.attach({',
+  '  getattr: function (path, cb) {',
+  '    if (path === "/") return cb(null, stat({mode: "dir", size: 4096}))',
+  '    cb(null, stat({mode: "file", size: 11}))',
+  '  },',
+  '  open: function (path, flags, cb) {',
+  '    cb(0, {fh: 42, directIo: true})',
+  '  },',
+  '  read: function (path, fd, buf, len, pos, cb) {',
+  '    var str = (worker.threadId + "").slice(pos, pos + len)',
+  '    if (!str) return cb(0)',
+  '    buf.write(str)',
+  '    cb(str.length)',
+  '  }',
+  '}))'
+].join('\n')
+
+tape('ops are sharded across workers by handle', function (t) {
+  var workers = [0, 1, 2, 3].map(function () {
+    return new worker.Worker(source, {eval: true})
+  })
+
+  var attached = workers.map(function (w) {
+    return new Promise(function (resolve) {
+      w.once('message', resolve)
+    })
+  })
+
+  Promise.all(attached).then(function (shards) {
+    var ops = {
+      force: true,
+      multithread: true,
+      shards: shards
+    }
+
+    fuse.mount(mnt, ops, function (err) {
+      t.error(err, 'no error')
+
+      var names = ['a', 'b', 'c', 'd', 'e', 'f', 'g', 'h']
+      var ids = {}
+      var missing = names.length
+
+      var read = function (fd, cb) {
+        var buf = new Buffer(16)
+        fs.read(fd, buf, 0, buf.length, 0, function (err, n) {
+          cb(err, buf.toString('utf-8', 0, n))
+        })
+      }
+
+      names.forEach(function (name) {
+        fs.open(path.join(mnt, name), 'r', function (err, fd) {
+          t.error(err, 'no error')
+          read(fd, function (err, first) {
+            t.error(err, 'no error')
+            read(fd, function (err, second) {
+              t.error(err, 'no error')
+              t.same(first, second, 'same worker for the handle of ' + name)
+              ids[first] = true
+              fs.close(fd, function () {
+                if (--missing) return
+                t.ok(Object.keys(ids).length > 1, 'more than one worker answered')
+                fuse.unmount(mnt, function () {
+                  workers.forEach(function (w) {
+                    w.terminate()
+                  })
+                  t.end()
+                })
+              })
+            })
+          })
+        })
+      })
+    })
+  })
+})
+
+tape('ops move to the other shards when a worker exits', function (t) {
+  var workers = [0, 1].map(function () {
+    return new worker.Worker(source, {eval: true})
+  })
+
+  var attached = workers.map(function (w) {
+    return new Promise(function (resolve) {
+      w.once('message', resolve)
+    })
+  })
+
+  Promise.all(attached).then(function (shards) {
+    fuse.mount(mnt, {force: true, multithread: true, shards: shards}, function (err) {
+      t.error(err, 'no error')
+
+      workers[0].once('exit', function () {
+        var names = ['a', 'b', 'c', 'd']
+        var missing = names.length
+
+        names.forEach(function (name) {
+          fs.readFile(path.join(mnt, name), 'utf-8', function (err, id) {
+            t.error(err, 'no error')
+            t.same(id, '' + workers[1].threadId, 'answered by the live worker')
+            if (--missing) return
+            fuse.unmount(mnt, function () {
+              workers[1].terminate()
+              t.end()
+            })
+          })
+        })
+      })
+      workers[0].terminate()
+    })
+  })
+})
+
+tape('readdir on a shard primes the attr cache', function (t) {
+  var w = new worker.Worker([
+    'var fuse = require(' + JSON.stringify(path.join(__dirname, '..')) + ')',
+    'var worker = require("worker_threads")',
+    'var stat = require(' + JSON.stringify(path.join(__dirname, 'fixtures/stat')) + ')',
+    'worker.parentPort.postMessage(fuse.attach({',
+    '  getattr: function (path, cb) {',
+    '    if (path === "/") return cb(null, stat({mode: "dir", size: 4096}))',
+    '    worker.parentPort.postMessage("getattr")',
+    '    cb(fuse.ENOENT)',
+    '  },',
+    '  readdir: function (path, cb) {',
+    '    cb(0, [',
+    '      {name: "a", stat: stat({mode: "file", size: 1}), ttl: 60000},',
+    '      {name: "b", stat: stat({mode: "file", size: 2}), ttl: 60000}',
+    '    ])',
+    '  }',
+    '}))'
+  ].join('\n'), {eval: true})
+
+  var calls = 0
+
+  w.once('message', function (shard) {
+    w.on('message', function () {
+      calls++
+    })
+
+    var ops = {
+      force: true,
+      attrCache: true,
+      options: ['attr_timeout=0', 'entry_timeout=0'],
+      shards: [shard]
+    }
+
+    fuse.mount(mnt, ops, function (err) {
+      t.error(err, 'no error')
+
+      fs.readdir(mnt, function (err, list) {
+        t.error(err, 'no error')
+        t.same(list.sort(), ['a', 'b'], 'lists entries')
+
+        fs.stat(path.join(mnt, 'b'), function (err, st) {
+          t.error(err, 'no error')
+          t.same(st.size, 2, 'stat from readdir')
+          t.same(calls, 0, 'no getattr call')
+
+          fuse.unmount(mnt, function () {
+            w.terminate()
+            t.end()
+          })
+        })
+      })
+    })
+  })
+})
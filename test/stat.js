@@ -0,0 +1,40 @@
+var mnt = require('./fixtures/mnt')
+var stat = require('./fixtures/stat')
+var fuse = require('../')
+var tape = require('tape')
+var fs = require('fs')
+var path = require('path')
+
+tape('typed array stat', function (t) {
+  var ops = {
+    force: true,
+    getattr: function (path, cb) {
+      if (path === '/') return cb(0, stat({mode: 'dir', size: 4096}))
+      if (path !== '/test') return cb(fuse.ENOENT)
+      var st = new Float64Array(16)
+      st[2] = 33188 // mode
+      st[3] = 1 // nlink
+      st[4] = process.getuid()
+      st[5] = process.getgid()
+      st[7] = 4294967306 // size, over 32 bits
+      st[12] = 1000000000 // mtime
+      st[13] = 500000000 // mtime nsec
+      cb(0, st)
+    }
+  }
+
+  fuse.mount(mnt, ops, function (err) {
+    t.error(err, 'no error')
+
+    fs.stat(path.join(mnt, 'test'), function (err, st) {
+      t.error(err, 'no error')
+      t.ok(st.isFile(), 'is a file')
+      t.same(st.size, 4294967306, 'size')
+      t.same(st.mtime.getTime(), 1000000000500, 'mtime with nanoseconds')
+
+      fuse.unmount(mnt, function () {
+        t.end()
+      })
+    })
+  })
+})
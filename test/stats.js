@@ -0,0 +1,51 @@
+var mnt = require('./fixtures/mnt')
+var stat = require('./fixtures/stat')
+var fuse = require('../')
+var tape = require('tape')
+var fs = require('fs')
+var path = require('path')
+
+tape('stats', function (t) {
+  var ops = {
+    force: true,
+    stats: true,
+    getattr: function (path, cb) {
+      if (path === '/') return cb(0, stat({mode: 'dir', size: 4096}))
+      if (path === '/test') return cb(0, stat({mode: 'file', size: 11}))
+      return cb(fuse.ENOENT)
+    },
+    open: function (path, flags, cb) {
+      cb(0, 42)
+    },
+    read: function (path, fd, buf, len, pos, cb) {
+      var str = 'hello world'.slice(pos, pos + len)
+      if (!str) return cb(0)
+      buf.write(str)
+      return cb(str.length)
+    }
+  }
+
+  fuse.mount(mnt, ops, function (err) {
+    t.error(err, 'no error')
+
+    fs.readFile(path.join(mnt, 'test'), function (err, buf) {
+      t.error(err, 'no error')
+      t.same(buf, new Buffer('hello world'), 'read file')
+
+      fs.stat(path.join(mnt, 'missing'), function (err) {
+        t.ok(err, 'had error')
+
+        var stats = fuse.stats(mnt)
+        t.ok(stats.getattr.total.count >= 2, 'counted getattrs')
+        t.ok(stats.getattr.errors.ENOENT >= 1, 'counted ENOENT')
+        t.ok(stats.getattr.js.p50 <= stats.getattr.js.max, 'p50 below max')
+        t.same(stats.read.bytes, 11, 'counted read bytes')
+        t.ok(stats.read.send && stats.read.queue && stats.read.post, 'has phases')
+
+        fuse.unmount(mnt, function () {
+          t.end()
+        })
+      })
+    })
+  })
+})
@@ -0,0 +1,52 @@
+var mnt = require('./fixtures/mnt')
+var stat = require('./fixtures/stat')
+var fuse = require('../')
+var tape = require('tape')
+var fs = require('fs')
+var os = require('os')
+var path = require('path')
+
+tape('trace', function (t) {
+  var ops = {
+    force: true,
+    trace: 1024,
+    getattr: function (path, cb) {
+      if (path === '/') return cb(0, stat({mode: 'dir', size: 4096}))
+      if (path === '/test') return cb(0, stat({mode: 'file', size: 0}))
+      return cb(fuse.ENOENT)
+    }
+  }
+
+  fuse.mount(mnt, ops, function (err) {
+    t.error(err, 'no error')
+
+    fs.stat(path.join(mnt, 'test'), function (err) {
+      t.error(err, 'no error')
+      fuse.trace.stop(mnt)
+
+      fs.stat(path.join(mnt, 'test'), function () {
+        var file = path.join(os.tmpdir(), 'fuse-bindings-trace.json')
+        var count = fuse.trace.events(mnt).traceEvents.length
+
+        fuse.trace.dump(mnt, file, function (err) {
+          t.error(err, 'no error')
+
+          var trace = JSON.parse(fs.readFileSync(file))
+          var getattrs = trace.traceEvents.filter(function (e) {
+            return e.name === 'getattr'
+          })
+
+          t.ok(getattrs.length >= 1, 'recorded getattr')
+          t.same(trace.traceEvents.length, count, 'nothing recorded after stop')
+          t.ok(getattrs[0].dur >= 0, 'has a duration')
+          t.ok(trace.traceEvents.some(function (e) { return e.name === 'js' }), 'has phases')
+
+          fs.unlinkSync(file)
+          fuse.unmount(mnt, function () {
+            t.end()
+          })
+        })
+      })
+    })
+  })
+})
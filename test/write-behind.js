@@ -0,0 +1,157 @@
+var mnt = require('./fixtures/mnt')
+var stat = require('./fixtures/stat')
+var fuse = require('../')
+var tape = require('tape')
+var fs = require('fs')
+var path = require('path')
+
+tape('write behind', function (t) {
+  var created = false
+  var data = new Buffer(0)
+  var writes = 0
+
+  var ops = {
+    force: true,
+    writeBehind: 4096,
+    getattr: function (path, cb) {
+      if (path === '/') return cb(null, stat({mode: 'dir', size: 4096}))
+      if (path === '/log' && created) return cb(null, stat({mode: 'file', size: data.length}))
+      return cb(fuse.ENOENT)
+    },
+    create: function (path, flags, cb) {
+      created = true
+      cb(0, 42)
+    },
+    open: function (path, flags, cb) {
+      cb(0, 42)
+    },
+    read: function (path, fd, buf, len, pos, cb) {
+      var slice = data.slice(pos, pos + len)
+      slice.copy(buf)
+      cb(slice.length)
+    },
+    write: function (path, fd, buf, len, pos, cb) {
+      writes++
+      var next = new Buffer(Math.max(data.length, pos + len))
+      next.fill(0)
+      data.copy(next)
+      buf.slice(0, len).copy(next, pos)
+      data = next
+      cb(len)
+    }
+  }
+
+  fuse.mount(mnt, ops, function (err) {
+    t.error(err, 'no error')
+
+    var file = path.join(mnt, 'log')
+    var expected = ''
+
+    fs.open(file, 'w', function (err, fd) {
+      t.error(err, 'no error')
+      loop(0)
+
+      function loop (i) {
+        if (i === 100) return done()
+        var line = 'line ' + i + '\n'
+        expected += line
+        fs.write(fd, new Buffer(line), 0, line.length, null, function (err) {
+          t.error(err)
+          loop(i + 1)
+        })
+      }
+
+      function done () {
+        fs.fstat(fd, function (err, st) {
+          t.error(err, 'no error')
+          t.same(st.size, expected.length, 'size includes buffered writes')
+
+          fs.close(fd, function (err) {
+            t.error(err, 'no error')
+            t.same(data.toString(), expected, 'all data was written')
+            t.ok(writes < 100, 'writes were coalesced (' + writes + ' js writes)')
+
+            fs.readFile(file, function (err, buf) {
+              t.error(err, 'no error')
+              t.same(buf.toString(), expected, 'reads see the data')
+
+              fuse.unmount(mnt, function () {
+                t.end()
+              })
+            })
+          })
+        })
+      }
+    })
+  })
+})
+
+tape('a slow flush does not hold up other handles', function (t) {
+  var files = {}
+  var stalled = null
+  var onstall = null
+
+  var ops = {
+    force: true,
+    writeBehind: 4096,
+    writeBehindAge: 10,
+    getattr: function (path, cb) {
+      if (path === '/') return cb(null, stat({mode: 'dir', size: 4096}))
+      if (files[path]) return cb(null, stat({mode: 'file', size: files[path].length}))
+      return cb(fuse.ENOENT)
+    },
+    create: function (path, flags, cb) {
+      files[path] = new Buffer(0)
+      cb(0, 42)
+    },
+    open: function (path, flags, cb) {
+      cb(0, 42)
+    },
+    read: function (path, fd, buf, len, pos, cb) {
+      var slice = files[path].slice(pos, pos + len)
+      slice.copy(buf)
+      cb(slice.length)
+    },
+    write: function (path, fd, buf, len, pos, cb) {
+      files[path] = Buffer.concat([files[path].slice(0, pos), buf.slice(0, len)])
+      if (path !== '/slow' || stalled) return cb(len)
+      // the background flush of /slow doesn't get its answer until /fast is done
+      stalled = function () {
+        cb(len)
+      }
+      onstall()
+    }
+  }
+
+  fuse.mount(mnt, ops, function (err) {
+    t.error(err, 'no error')
+
+    var slowFd = null
+    onstall = function () {
+      var fast = path.join(mnt, 'fast')
+      fs.writeFile(fast, 'fast', function (err) {
+        t.error(err, 'no error')
+        fs.readFile(fast, function (err, buf) {
+          t.error(err, 'no error')
+          t.same(buf.toString(), 'fast', 'read another file while a flush is pending')
+
+          stalled()
+          fs.close(slowFd, function (err) {
+            t.error(err, 'no error')
+            t.same(files['/slow'].toString(), 'slow', 'slow file was written')
+            fuse.unmount(mnt, function () {
+              t.end()
+            })
+          })
+        })
+      })
+    }
+    fs.open(path.join(mnt, 'slow'), 'w', function (err, fd) {
+      t.error(err, 'no error')
+      slowFd = fd
+      fs.write(fd, new Buffer('slow'), 0, 4, null, function (err) {
+        t.error(err, 'no error')
+      })
+    })
+  })
+})
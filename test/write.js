@@ -4,6 +4,7 @@ var fuse = require('../')
 var tape = require('tape')
 var fs = require('fs')
 var path = require('path')
+var os = require('os')
 
 tape('write', function (t) {
   var created = false
@@ -52,3 +53,50 @@ tape('write', function (t) {
     })
   })
 })
+
+tape('write to backing fd', function (t) {
+  var backing = path.join(os.tmpdir(), 'fuse-bindings-backing-' + process.pid)
+  var backingFd = fs.openSync(backing, 'w+')
+  var created = false
+  var notified = 0
+  var size = 0
+
+  var ops = {
+    force: true,
+    getattr: function (path, cb) {
+      if (path === '/') return cb(null, stat({mode: 'dir', size: 4096}))
+      if (path === '/hello' && created) return cb(null, stat({mode: 'file', size: size}))
+      return cb(fuse.ENOENT)
+    },
+    truncate: function (path, size, cb) {
+      cb(0)
+    },
+    create: function (path, flags, cb) {
+      created = true
+      cb(0, {fh: 42, backingFd: backingFd})
+    },
+    write: function (path, fd, buf, len, pos, cb) {
+      t.same(fd, 42, 'fh is passed')
+      t.same(buf, null, 'no buffer for backed writes')
+      notified += len
+      size = Math.max(pos + len, size)
+      cb(len)
+    }
+  }
+
+  fuse.mount(mnt, ops, function (err) {
+    t.error(err, 'no error')
+
+    fs.writeFile(path.join(mnt, 'hello'), 'hello world', function (err) {
+      t.error(err, 'no error')
+      t.same(notified, 11, 'write was reported')
+      t.same(fs.readFileSync(backing, 'utf-8'), 'hello world', 'data went to the backing file')
+
+      fuse.unmount(mnt, function () {
+        fs.closeSync(backingFd)
+        fs.unlinkSync(backing)
+        t.end()
+      })
+    })
+  })
+})
@@ -0,0 +1,74 @@
+#include "trace.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+
+bindings_trace_t *bindings_trace_new () {
+  bindings_trace_t *trace = new bindings_trace_t();
+  trace->enabled.store(0);
+  trace->head.store(0);
+  trace->mask = 0;
+  trace->events = NULL;
+  return trace;
+}
+
+void bindings_trace_destroy (bindings_trace_t *trace) {
+  free(trace->events);
+  delete trace;
+}
+
+int bindings_trace_start (bindings_trace_t *trace, size_t size) {
+  if (trace->events == NULL) {
+    size_t capacity = 1;
+    while (capacity < size) capacity <<= 1;
+
+    bindings_trace_event_t *events = (bindings_trace_event_t *) calloc(capacity, sizeof(bindings_trace_event_t));
+    if (events == NULL) return -1;
+    for (size_t i = 0; i < capacity; i++) new (events + i) bindings_trace_event_t();
+
+    trace->mask = capacity - 1;
+    trace->events = events;
+  }
+
+  trace->enabled.store(1, std::memory_order_release);
+  return 0;
+}
+
+void bindings_trace_stop (bindings_trace_t *trace) {
+  trace->enabled.store(0, std::memory_order_release);
+}
+
+size_t bindings_trace_snapshot (bindings_trace_t *trace, double *out) {
+  if (trace->events == NULL) return 0;
+
+  uint64_t head = trace->head.load(std::memory_order_acquire);
+  uint64_t start = head > trace->mask + 1 ? head - trace->mask - 1 : 0;
+  size_t length = 0;
+
+  for (uint64_t i = start; i < head; i++) {
+    bindings_trace_event_t *event = trace->events + (i & trace->mask);
+    if (event->seq.load(std::memory_order_acquire) != i + 1) continue; // still being written or already overwritten
+
+    double *o = out + length * BINDINGS_TRACE_FIELDS;
+    o[0] = (double) event->enter;
+    o[1] = (double) event->send;
+    o[2] = (double) event->dispatch;
+    o[3] = (double) event->callback;
+    o[4] = (double) event->done;
+    o[5] = event->op;
+    o[6] = event->slot;
+    o[7] = event->result;
+    o[8] = event->pid;
+    o[9] = event->hash;
+    o[10] = (double) event->ino;
+    o[11] = (double) event->fh;
+    o[12] = (double) event->offset;
+    o[13] = (double) event->length;
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (event->seq.load(std::memory_order_relaxed) == i + 1) length++;
+  }
+
+  return length;
+}
@@ -0,0 +1,67 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+// Fixed size ring of finished requests. Writers claim a slot with one fetch_add and
+// publish it with a sequence store, readers copy a slot and then check the sequence
+// didn't move (seqlock), so recording never blocks a fuse thread.
+
+#define BINDINGS_TRACE_SIZE 65536
+#define BINDINGS_TRACE_FIELDS 14 // doubles per event in a snapshot, in the order of bindings_trace_event_t
+
+struct bindings_trace_event_t {
+  std::atomic<uint64_t> seq; // index + 1 once written, 0 while a writer is in it
+
+  // uv_hrtime stamps, see PHASE_* in stats.h
+  uint64_t enter;
+  uint64_t send;
+  uint64_t dispatch;
+  uint64_t callback;
+  uint64_t done;
+
+  int32_t op;
+  int32_t slot;
+  int32_t result;
+  int32_t pid;
+  uint32_t hash; // fnv-1a of the path (or name in lowlevel mode)
+  uint64_t ino;
+  uint64_t fh;
+  int64_t offset;
+  int64_t length;
+};
+
+// events is allocated by the first start and kept until the trace is destroyed,
+// so writers only have to check enabled
+struct bindings_trace_t {
+  std::atomic<int> enabled;
+  std::atomic<uint64_t> head;
+  uint64_t mask;
+  bindings_trace_event_t *events;
+};
+
+static inline bool bindings_tracing (bindings_trace_t *trace) {
+  return trace->enabled.load(std::memory_order_acquire) != 0;
+}
+
+static inline bindings_trace_event_t *bindings_trace_claim (bindings_trace_t *trace, uint64_t *index) {
+  *index = trace->head.fetch_add(1, std::memory_order_relaxed);
+  bindings_trace_event_t *event = trace->events + (*index & trace->mask);
+  event->seq.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  return event;
+}
+
+static inline void bindings_trace_commit (bindings_trace_event_t *event, uint64_t index) {
+  event->seq.store(index + 1, std::memory_order_release);
+}
+
+bindings_trace_t *bindings_trace_new ();
+void bindings_trace_destroy (bindings_trace_t *trace);
+
+// size is only used the first time, returns -1 if the ring couldn't be allocated
+int bindings_trace_start (bindings_trace_t *trace, size_t size);
+void bindings_trace_stop (bindings_trace_t *trace);
+
+// copies the events still in the ring into out (BINDINGS_TRACE_FIELDS per event, room for
+// the whole ring), oldest first. returns the number of events copied
+size_t bindings_trace_snapshot (bindings_trace_t *trace, double *out);